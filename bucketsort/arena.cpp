@@ -0,0 +1,79 @@
+/*
+ *  @fileName       :   arena.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <algorithm>
+
+#include "arena.h"
+#include "memplace.h"
+
+using namespace std;
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   hands out memory from the current chunk, a new chunk is taken
+ *                  from the system when the current one is exhausted. Requests
+ *                  larger than ARENA_CHUNK get a chunk of their own. Chunks
+ *                  follow --thp and --mem-policy, and with first touch the
+ *                  calling thread touches the memory it is handed
+ *
+ * @params      :   size_t
+ *                      bytes   :   size of the request
+ *                      align   :   alignment of the request, a power of two
+ *
+ * @returns     :   void*
+ *                      memory valid until release()
+ */
+void* Arena::alloc(size_t bytes, size_t align)
+{
+    uintptr_t p = (uintptr_t)(chunk + used);
+    p = (p + align - 1) & ~(uintptr_t)(align - 1);
+
+    if ((chunk == NULL) || (p + bytes > (uintptr_t)(chunk + size)))
+    {
+        size = max((size_t)ARENA_CHUNK, bytes + align);
+        chunk = (char*)mem_alloc(size);
+        chunks.push_back({chunk, size});
+        used = 0;
+
+        p = (uintptr_t)chunk;
+        p = (p + align - 1) & ~(uintptr_t)(align - 1);
+    }
+
+    used = (p + bytes) - (uintptr_t)chunk;
+
+    if (memPolicy == MEM_FIRST_TOUCH)
+    {
+        //pages land on the node of the owner, not of the first thread inserting
+        mem_touch((void*)p, bytes);
+    }
+    return (void*)p;
+}
+
+/*
+ * @brief       :   frees every chunk of the arena at once, memory handed out
+ *                  before must not be used afterwards
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void Arena::release()
+{
+    for (auto& c : chunks)
+    {
+        mem_free(c.first, c.second);
+    }
+    chunks.clear();
+    chunk = NULL;
+    used = 0;
+    size = 0;
+}
+
+/*EOF*/
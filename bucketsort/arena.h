@@ -0,0 +1,98 @@
+/*
+ *  @fileName       :   arena.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <cstdbool>
+
+/*GLOBAL DEFINES*/
+#define ARENA_CHUNK (1 << 20)   /*bytes requested from the system at a time*/
+
+/*Bump allocator class definition. Every thread owns one arena, so allocating never
+  takes a lock. Memory is not freed piece by piece, release() frees everything*/
+class alignas(64) Arena
+{
+    public:
+        char *chunk;                    /*chunk memory is currently handed out from*/
+        size_t used;                    /*bytes of the chunk handed out so far*/
+        size_t size;                    /*bytes of the chunk*/
+        std::vector<std::pair<char*, size_t>> chunks;   /*every chunk of this arena and its size, freed by release()*/
+
+        void* alloc(size_t bytes, size_t align);    //defined in arena.cpp
+
+        void release();                             //defined in arena.cpp
+};
+
+/*STL allocator handing out memory of an arena, falls back to the heap without one.
+  deallocate() is a no-op for arena memory, it is freed with the arena*/
+template <typename T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        Arena *arena;
+
+        ArenaAllocator(Arena *a = NULL) noexcept : arena(a) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+        T* allocate(size_t n)
+        {
+            if (arena == NULL)
+            {
+                return std::allocator<T>().allocate(n);
+            }
+            return (T*)arena->alloc(n * sizeof(T), alignof(T));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (arena == NULL)
+            {
+                std::allocator<T>().deallocate(p, n);
+            }
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+/*
+ * @brief       :   constructs an object in an arena, it must not be deleted
+ *
+ * @params      :   Arena
+ *                      *arena  :   arena the object is allocated from
+ *                  Args
+ *                      args    :   constructor arguments
+ *
+ * @returns     :   T*
+ *                      constructed object
+ */
+template <typename T, typename... Args>
+T* arena_new(Arena *arena, Args&&... args)
+{
+    return new (arena->alloc(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+}
+
+#endif /*_ARENA_H_*/
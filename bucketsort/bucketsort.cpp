@@ -10,32 +10,29 @@
 /*Include other header files*/
 #include "bucketsort.h" 
 #include "time.h"
+#include "perf.h"
+#include "affinity.h"
+#include "threadpool.h"
+#include "workqueue.h"
+#include "classify.h"
+#include "arena.h"
+#include "memplace.h"
+#include "merge.h"
+#include "phasetimer.h"
+#include "locktrace.h"
 
 /*Private defines and macros*/
 #define BUCKET_DIVIDER (100)
 #define TOTAL_NUMS (list_size)
+#define SPLIT_THRESHOLD (4096)  //buckets larger than this are split into subtasks
+#define DEQUE_SLACK (64)        //deque slots for subtasks, on top of the initial buckets
+#define RADIX_BITS (8)          //width of one digit of the radix engine
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_BUCKETS - 1)
+#define WC_SIZE (16)            //elements of one write-combining buffer, one cache line
 
 using namespace std;
 
-/*Global variables*/
-int list_size;                  //total number of elements in the list
-int num_buckets;                //number of buckets
-static vector<thread*> threads; //vector of threads, declared static because merge_sort.cpp also has vector of threads
-vector<set<int>> buckets;       //global vector of sets
-
-TAS *taslock;                           /*pointer to TAS lock implementation class*/
-TTAS *ttaslock;                         /*pointer to TTAS lock implementation class*/
-TicketLock *tktlock;                    /*pointer to Ticket lock implementation class*/
-MCS *mcslock;                           /*pointer to MCS lock implementation class*/
-mutex *mutexlock;                       /*pointer to Mutex lock implementation class*/
-Peterson *petersonseqlock;              /*pointer to Peterson lock implementation class, used for sequential consistency*/
-Peterson *petersonrellock;              /*pointer to Peterson lock implementation class, used for released consistency*/
-Barrier *sensebar;                      /*pointer to sense reversal barrier implementation class*/
-barrier<> *pthreadbar;                  /*pointer to pthread barrier implementation class*/
-
-lock_algs_t locktype = PTHREAD_algorithm;   /*locking algorithm to be used, mutex default*/
-barrier_types_t bartype = PTHREAD_type;     /*barrier type to be used, pthread barrier default*/
-
 /*Private typedefs, classes, structs and unions*/
 typedef struct threadParams
 {
@@ -44,6 +41,134 @@ typedef struct threadParams
     int high;
 }threadParams_t;
 
+/*per-thread state needed by the locking algorithms*/
+typedef struct lockContext
+{
+    size_t threadId;    /*for Peterson's algorithm*/
+    Node *node;         /*for MCS & cohort locks*/
+    CLHNode *clhnode;   /*for timeout CLH lock, valid while the lock is held*/
+    int myNode;         /*for cohort locks*/
+}lockContext_t;
+
+/*digit counts of one thread in the radix engine, padded to avoid false sharing*/
+typedef struct alignas(CACHE_LINE_SIZE) radixHist
+{
+    int count[RADIX_BUCKETS];
+}radixHist_t;
+
+/*State of one sorter. Every buffer, lock, barrier and the thread pool belong to
+  the sorter, so sorters on different threads do not share anything but the
+  read-only settings of the command line*/
+class SortEngine
+{
+    public:
+        sorterConfig_t config;          /*settings of the current sort*/
+        ThreadPool *pool;               /*workers of this sorter, created on first use*/
+        struct timespec startTime, endTime;     /*timed region of the last sort*/
+
+        int list_size;                  //total number of elements in the list
+        int num_buckets;                //number of buckets
+        size_t num_threads;             //number of threads sorting the current list
+        vector<vector<int, ArenaAllocator<int>>> buckets;   //buckets, sorted after they are filled
+        classifier_t classifier;        //bucket divisor and kernels of the current sort
+
+        TAS *taslock;                           /*pointer to TAS lock implementation class*/
+        TTAS *ttaslock;                         /*pointer to TTAS lock implementation class*/
+        TicketLock *tktlock;                    /*pointer to Ticket lock implementation class*/
+        MCS *mcslock;                           /*pointer to MCS lock implementation class*/
+        mutex *mutexlock;                       /*pointer to Mutex lock implementation class*/
+        Peterson *petersonseqlock;              /*pointer to Peterson lock implementation class, used for sequential consistency*/
+        Peterson *petersonrellock;              /*pointer to Peterson lock implementation class, used for released consistency*/
+        CohortBOMCS *cbomcslock;                /*pointer to C-BO-MCS cohort lock implementation class*/
+        CohortTktTkt *ctktlock;                 /*pointer to C-TKT-TKT cohort lock implementation class*/
+        TimeoutCLH *clhlock;                    /*pointer to timeout CLH lock implementation class*/
+        Barrier *sensebar;                      /*pointer to sense reversal barrier implementation class*/
+        barrier<> *pthreadbar;                  /*pointer to pthread barrier implementation class*/
+
+        lock_algs_t locktype;                   /*locking algorithm of the current sort*/
+        barrier_types_t bartype;                /*barrier type of the current sort*/
+        lockTrace_t lockTrace;                  /*contention tracing state of the bucket lock, with --lock-trace*/
+
+        vector<threadParams_t> params;  //range of every thread, indexed by threadId-1
+        int *sortArr;                   //array being sorted by the pool
+        int *workArr;                   //array the engines work on, sortArr itself or a placed copy
+        WSDeque *deques;                //one work-stealing deque per thread, indexed by threadId-1
+        atomic<long> tasksLeft;         //bucket sort tasks pushed but not finished yet
+        vector<int> shareSize;          //elements in the buckets of every thread, indexed by threadId-1
+        vector<vector<int>> bucketHist; //elements of every thread per bucket, indexed by threadId-1
+        Arena *arenas;                  //one allocation arena per thread, indexed by threadId-1
+
+        vector<radixHist_t> radixHist[2];   //digit counts of every thread, for even and odd passes
+        vector<int> radixTmp;               //second array the radix engine scatters into
+        int *tmpArr;                        //radixTmp itself or a placed array
+        vector<const int*> mergeSeqs;       //sorted range of every thread, merged by the mergesort engine
+        vector<long> mergeLens;             //elements of every range
+        vector<uint64_t> keyMin, keyMax;    //smallest and largest key bits of every thread, generic engine
+
+        void TAS_init();                    //locks and barriers, defined below
+        void TAS_delete();
+        void TTAS_init();
+        void TTAS_delete();
+        void TicketLock_init();
+        void TicketLock_delete();
+        void MCS_init();
+        void MCS_delete();
+        void mutex_init();
+        void mutex_delete();
+        void petersonSeq_init();
+        void petersonSeq_delete();
+        void petersonRel_init();
+        void petersonRel_delete();
+        void cohortBOMCS_init();
+        void cohortBOMCS_delete();
+        void cohortTktTkt_init();
+        void cohortTktTkt_delete();
+        void timeoutCLH_init();
+        void timeoutCLH_delete();
+        void lock_init(lock_algs_t alg);
+        void lock_delete(lock_algs_t alg);
+        void pthread_barrier_init(size_t num_threads);
+        void pthread_barrier_delete();
+        void sense_barrier_init(size_t num_threads);
+        void sense_barrier_delete();
+        void barrier_init(size_t num_threads, barrier_types_t bar);
+        void barrier_delete(barrier_types_t bar);
+
+        void deques_init(size_t num_threads, int numTasks);     //per-thread state, defined below
+        void deques_delete(size_t num_threads);
+        void arenas_init(size_t num_threads);
+        void arenas_delete(size_t num_threads);
+        void place_range_in(threadParams_t *params, bool withTmp);
+        void place_range_out(threadParams_t *params);
+        void phase_barrier();
+
+        void bucket_lock(lockContext_t *ctx);                   //bucket engine, defined below
+        bool bucket_trylock(lockContext_t *ctx);
+        void bucket_unlock(lockContext_t *ctx);
+        int bucket_index(int num);
+        template <typename Bucket>
+        bool stage_flush(lockContext_t *ctx, Bucket& bucket, Bucket& stage, bool tryOnly);
+        template <typename T, typename Less>
+        void run_task(WSDeque *mine, sortTask_t *task, vector<vector<T, ArenaAllocator<T>>>& bkts, Less less);
+        template <typename T, typename Less>
+        void sortBuckets(size_t threadId, vector<vector<T, ArenaAllocator<T>>>& bkts, T *out, Less less);
+
+        void* fillBuckets(threadParams_t* params, int* arr);    //worker functions, defined below
+        void* radixSort(threadParams_t* params, int* arr);
+        void* mergeSort(threadParams_t* params, int* arr);
+        template <typename T, typename BucketOf>
+        void* fillBuckets_generic(threadParams_t* params, T* arr, vector<vector<T, ArenaAllocator<T>>>& bkts);
+
+        size_t sort_threads(size_t nums);                       //entry points, defined below
+        void pool_run(pool_job_t fn, size_t numThreads);
+        void sort_setup(int nums, size_t numThreads);
+        void sort_int(int *arr, size_t nums);
+        template <typename T, typename BucketOf>
+        void sort_generic(T *arr, size_t nums);
+};
+
+static thread_local Arena *myArena;     //arena of the calling thread, set when a worker starts
+
 /*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Initializes the pointer to TAS lock implementation
@@ -52,7 +177,7 @@ typedef struct threadParams
  * 
  * @returns     :   None
  */
-static void TAS_init()
+void SortEngine::TAS_init()
 {
     //we will lock each bucket individually
     taslock = new TAS;
@@ -66,7 +191,7 @@ static void TAS_init()
  * 
  * @returns     :   None
  */
-static void TAS_delete()
+void SortEngine::TAS_delete()
 {
     delete taslock;
 }
@@ -78,7 +203,7 @@ static void TAS_delete()
  * 
  * @returns     :   None
  */
-static void TTAS_init()
+void SortEngine::TTAS_init()
 {
     ttaslock = new TTAS;
     ttaslock->ttaslock.store(false, SEQ_CST);
@@ -91,7 +216,7 @@ static void TTAS_init()
  * 
  * @returns     :   None
  */
-static void TTAS_delete()
+void SortEngine::TTAS_delete()
 {
     delete ttaslock;
 }
@@ -103,7 +228,7 @@ static void TTAS_delete()
  * 
  * @returns     :   None
  */
-static void TicketLock_init()
+void SortEngine::TicketLock_init()
 {
     tktlock = new TicketLock;
     tktlock->next_num.store(0, SEQ_CST);
@@ -117,7 +242,7 @@ static void TicketLock_init()
  * 
  * @returns     :   None
  */
-static void TicketLock_delete()
+void SortEngine::TicketLock_delete()
 {
     delete tktlock;
 }
@@ -129,7 +254,7 @@ static void TicketLock_delete()
  * 
  * @returns     :   None
  */
-static void MCS_init()
+void SortEngine::MCS_init()
 {
     mcslock = new MCS;
     mcslock->tail.store(NULL, SEQ_CST);
@@ -142,7 +267,7 @@ static void MCS_init()
  * 
  * @returns     :   None
  */
-static void MCS_delete()
+void SortEngine::MCS_delete()
 {
     delete mcslock;
 }
@@ -154,7 +279,7 @@ static void MCS_delete()
  * 
  * @returns     :   None
  */
-static void mutex_init()
+void SortEngine::mutex_init()
 {
     mutexlock = new mutex;
 }
@@ -165,7 +290,7 @@ static void mutex_init()
  * 
  * @returns     :   None
  */
-static void mutex_delete()
+void SortEngine::mutex_delete()
 {
     delete mutexlock;
 }
@@ -178,7 +303,7 @@ static void mutex_delete()
  * 
  * @returns     :   None
  */
-static void petersonSeq_init()
+void SortEngine::petersonSeq_init()
 {
     petersonseqlock = new Peterson;
     petersonseqlock->desires[0].store(false, SEQ_CST);
@@ -194,7 +319,7 @@ static void petersonSeq_init()
  * 
  * @returns     :   None
  */
-static void petersonSeq_delete()
+void SortEngine::petersonSeq_delete()
 {
     delete petersonseqlock;
 }
@@ -207,7 +332,7 @@ static void petersonSeq_delete()
  * 
  * @returns     :   None
  */
-static void petersonRel_init()
+void SortEngine::petersonRel_init()
 {
     petersonrellock = new Peterson;
     petersonrellock->desires[0].store(false, SEQ_CST);
@@ -223,11 +348,111 @@ static void petersonRel_init()
  * 
  * @returns     :   None
  */
-static void petersonRel_delete()
+void SortEngine::petersonRel_delete()
 {
     delete petersonrellock;
 }
 /*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to C-BO-MCS cohort lock implementation
+ *                  with one local MCS lock per node
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::cohortBOMCS_init()
+{
+    cbomcslock = new CohortBOMCS;
+    cbomcslock->global.bolock.store(false, SEQ_CST);
+    cbomcslock->numNodes = topology_lock_nodes();
+    cbomcslock->passBound = cohortPassBound;
+    cbomcslock->cohorts = new MCSCohort[cbomcslock->numNodes];
+    for (int i = 0; i < cbomcslock->numNodes; i++)
+    {
+        cbomcslock->cohorts[i].local.tail.store(NULL, SEQ_CST);
+        cbomcslock->cohorts[i].ownsGlobal = false;
+        cbomcslock->cohorts[i].passCount = 0;
+    }
+}
+
+/*
+ * @brief       :   Deletes the pointer to C-BO-MCS cohort lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::cohortBOMCS_delete()
+{
+    delete[] cbomcslock->cohorts;
+    delete cbomcslock;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to C-TKT-TKT cohort lock implementation
+ *                  with one local ticket lock per node
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::cohortTktTkt_init()
+{
+    ctktlock = new CohortTktTkt;
+    ctktlock->global.next_num.store(0, SEQ_CST);
+    ctktlock->global.now_serving.store(0, SEQ_CST);
+    ctktlock->numNodes = topology_lock_nodes();
+    ctktlock->passBound = cohortPassBound;
+    ctktlock->cohorts = new TicketCohort[ctktlock->numNodes];
+    for (int i = 0; i < ctktlock->numNodes; i++)
+    {
+        ctktlock->cohorts[i].local.next_num.store(0, SEQ_CST);
+        ctktlock->cohorts[i].local.now_serving.store(0, SEQ_CST);
+        ctktlock->cohorts[i].ownsGlobal = false;
+        ctktlock->cohorts[i].passCount = 0;
+    }
+}
+
+/*
+ * @brief       :   Deletes the pointer to C-TKT-TKT cohort lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::cohortTktTkt_delete()
+{
+    delete[] ctktlock->cohorts;
+    delete ctktlock;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to timeout CLH lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::timeoutCLH_init()
+{
+    clhlock = new TimeoutCLH;
+    clhlock->tail.store(NULL, SEQ_CST);
+}
+
+/*
+ * @brief       :   Deletes the pointer to timeout CLH lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::timeoutCLH_delete()
+{
+    clhlock->cleanup();
+    delete clhlock;
+}
+/*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Initialize lock
  *
@@ -236,7 +461,7 @@ static void petersonRel_delete()
  * 
  * @returns     :   None
  */
-static void lock_init(lock_algs_t alg)
+void SortEngine::lock_init(lock_algs_t alg)
 {
     switch(locktype)
     {
@@ -247,6 +472,9 @@ static void lock_init(lock_algs_t alg)
         case PTHREAD_algorithm:         mutex_init(); break;
         case PETERSON_SEQ_algorithm:    petersonSeq_init(); break;
         case PETERSON_REL_algorithm:    petersonRel_init(); break;
+        case COHORT_BO_MCS_algorithm:   cohortBOMCS_init(); break;
+        case COHORT_TKT_TKT_algorithm:  cohortTktTkt_init(); break;
+        case TIMEOUT_CLH_algorithm:     timeoutCLH_init(); break;
         default:                        mutex_init(); break; 
     }
 }
@@ -258,7 +486,7 @@ static void lock_init(lock_algs_t alg)
  * 
  * @returns     :   None
  */
-static void lock_delete(lock_algs_t alg)
+void SortEngine::lock_delete(lock_algs_t alg)
 {
     switch(locktype)
     {
@@ -269,6 +497,9 @@ static void lock_delete(lock_algs_t alg)
         case PTHREAD_algorithm:         mutex_delete(); break;
         case PETERSON_SEQ_algorithm:    petersonSeq_delete(); break;
         case PETERSON_REL_algorithm:    petersonRel_delete(); break;
+        case COHORT_BO_MCS_algorithm:   cohortBOMCS_delete(); break;
+        case COHORT_TKT_TKT_algorithm:  cohortTktTkt_delete(); break;
+        case TIMEOUT_CLH_algorithm:     timeoutCLH_delete(); break;
         default:                        mutex_delete(); break; 
     }
 }
@@ -281,7 +512,7 @@ static void lock_delete(lock_algs_t alg)
  * 
  * @returns     :   None
  */
-static void pthread_barrier_init(size_t num_threads)
+void SortEngine::pthread_barrier_init(size_t num_threads)
 {
     pthreadbar = new barrier(num_threads);
 }
@@ -293,7 +524,7 @@ static void pthread_barrier_init(size_t num_threads)
  * 
  * @returns     :   None
  */
-static void pthread_barrier_delete()
+void SortEngine::pthread_barrier_delete()
 {
     delete pthreadbar;
 }
@@ -306,7 +537,7 @@ static void pthread_barrier_delete()
  * 
  * @returns     :   None
  */
-static void sense_barrier_init(size_t num_threads)
+void SortEngine::sense_barrier_init(size_t num_threads)
 {
     sensebar = new Barrier;
     sensebar->count.store(0, SEQ_CST);
@@ -321,7 +552,7 @@ static void sense_barrier_init(size_t num_threads)
  * 
  * @returns     :   None
  */
-static void sense_barrier_delete()
+void SortEngine::sense_barrier_delete()
 {
     delete sensebar;
 }
@@ -336,7 +567,7 @@ static void sense_barrier_delete()
  * 
  * @returns     :   None
  */
-static void barrier_init(size_t num_threads, barrier_types_t bar)
+void SortEngine::barrier_init(size_t num_threads, barrier_types_t bar)
 {
     switch(bar)
     {
@@ -353,7 +584,7 @@ static void barrier_init(size_t num_threads, barrier_types_t bar)
  * 
  * @returns     :   None
  */
-static void barrier_delete(barrier_types_t bar)
+void SortEngine::barrier_delete(barrier_types_t bar)
 {
     switch(bar)
     {
@@ -365,179 +596,989 @@ static void barrier_delete(barrier_types_t bar)
 
 /*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   worker function for each thread
- * 
- * @parameters  :   threadParams_t 
- *                      *params    :   pointer to structure containing thread params
- *                  vector <int>* 
- *                      arr         :   pointer to the array to be sorted
+ * @brief       :   Initialize one work-stealing deque per thread
  *
- * @returns     :   NULL
+ * @params      :   size_t 
+ *                      num_threads     :   Number of threads
+ *                  int
+ *                      numTasks        :   most tasks a thread pushes before it
+ *                                          starts popping
+ * 
+ * @returns     :   None
  */
-void* fillBuckets(threadParams_t* params, vector<int>* arr)
+void SortEngine::deques_init(size_t num_threads, int numTasks)
 {
-    int i = params->low;        //index for iterations between range
-    int bkt_idx = 0;    //bucket index to store the element
-    int num=0;          //element to be stored in the bucket
-    Node *thisNode = new Node;  /*for MCS lock*/
-
-    //barrier wait here 
-    switch(bartype)
-    {
-        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
-        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
-        default:                        pthreadbar->arrive_and_wait(); break;
-    }
-     
-    //main thread records start time here
-    if (params->threadId == 1)
+    long capacity = 1;
+    while (capacity < numTasks + DEQUE_SLACK)
     {
-        getTime(&startTime);
+        capacity <<= 1;
     }
 
-    //barrier wait here 
-    switch(bartype)
+    deques = new WSDeque[num_threads];
+    for (size_t i = 0; i < num_threads; i++)
     {
-        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
-        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
-        default:                        pthreadbar->arrive_and_wait(); break;
+        deques[i].top.store(0, SEQ_CST);
+        deques[i].bottom.store(0, SEQ_CST);
+        deques[i].tasks = new atomic<sortTask_t*>[capacity];
+        deques[i].mask = capacity - 1;
     }
+    tasksLeft.store(0, SEQ_CST);
+}
 
-    while (i <=  params->high)
+/*
+ * @brief       :   Delete work-stealing deques
+ *
+ * @params      :   size_t 
+ *                      num_threads     :   Number of threads
+ * 
+ * @returns     :   None
+ */
+void SortEngine::deques_delete(size_t num_threads)
+{
+    for (size_t i = 0; i < num_threads; i++)
     {
-        num = arr->at(i);                   //get element
-        bkt_idx = (int)num/num_buckets;     //determine which bucket it belongs to
-
-        //to avoid segmentation fault
-        if(bkt_idx >= num_buckets)
-        {
-            bkt_idx = num_buckets - 1;
-        }
-
-        //acquire lock
-        switch(locktype)
-        {
-            case TAS_algorithm:             taslock->TAS::TAS_lock(); break;
-            case TTAS_algorithm:            ttaslock->TTAS::TTAS_lock(); break;
-            case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_lock(); break;
-            case MCS_algorithm:             mcslock->MCS::acquire(thisNode); break;
-            case PTHREAD_algorithm:         mutexlock->lock(); break;
-            case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_lock(params->threadId); break;
-            case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_lock(params->threadId); break;
-            default:                        mutexlock->lock(); break;
-        }
-
-        //store element in the bucket
-        buckets[bkt_idx].insert(num);
+        delete[] deques[i].tasks;
+    }
+    delete[] deques;
+}
 
-        //release the lock
-        switch(locktype)
-        {
-            case TAS_algorithm:             taslock->TAS::TAS_unlock(); break;
-            case TTAS_algorithm:            ttaslock->TTAS::TTAS_unlock(); break;
-            case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_unlock(); break;
-            case MCS_algorithm:             mcslock->MCS::release(thisNode); break;
-            case PTHREAD_algorithm:         mutexlock->unlock(); break;
-            case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_unlock(params->threadId); break;
-            case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_unlock(params->threadId); break;
-            default:                        mutexlock->unlock(); break;
-        }
 
-        //update index
-        i++;
+/*
+ * @brief       :   Initializes one allocation arena per thread
+ *
+ * @params      :   size_t 
+ *                      num_threads     :   Number of threads
+ * 
+ * @returns     :   None
+ */
+void SortEngine::arenas_init(size_t num_threads)
+{
+    arenas = new Arena[num_threads];
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        arenas[i].chunk = NULL;
+        arenas[i].used = 0;
+        arenas[i].size = 0;
     }
-    
-    delete thisNode; /*delete the node for MCS lock*/
+}
 
-    //barrier wait here
-    switch(bartype)
+/*
+ * @brief       :   Releases every arena with all memory allocated from it
+ *
+ * @params      :   size_t 
+ *                      num_threads     :   Number of threads
+ * 
+ * @returns     :   None
+ */
+void SortEngine::arenas_delete(size_t num_threads)
+{
+    for (size_t i = 0; i < num_threads; i++)
     {
-        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
-        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
-        default:                        pthreadbar->arrive_and_wait(); break;
+        arenas[i].release();
     }
+    delete[] arenas;
+}
 
-    //main thread records end time here
-    if (params->threadId == 1)
+/*
+ * @brief       :   copies the range of a thread into the placed array, so that
+ *                  its pages are touched first by the thread working on them.
+ *                  Called before the timed region
+ *
+ * @params      :   threadParams_t
+ *                      *params     :   range of the calling thread
+ *                  bool
+ *                      withTmp     :   touch the same range of the radix array too
+ * 
+ * @returns     :   None
+ */
+void SortEngine::place_range_in(threadParams_t *params, bool withTmp)
+{
+    if (!mem_placed())
     {
-        getTime(&endTime);
+        return;
+    }
+    size_t bytes = (params->high - params->low + 1) * sizeof(int);
+    memcpy(&workArr[params->low], sortArr + params->low, bytes);
+    if (withTmp)
+    {
+        mem_touch(&tmpArr[params->low], bytes);
     }
+}
 
-    //barrier wait here
+/*
+ * @brief       :   copies the range of a thread from the placed array back to
+ *                  the array of the caller. Called after the timed region
+ *
+ * @params      :   threadParams_t
+ *                      *params     :   range of the calling thread
+ * 
+ * @returns     :   None
+ */
+void SortEngine::place_range_out(threadParams_t *params)
+{
+    if (!mem_placed())
+    {
+        return;
+    }
+    size_t bytes = (params->high - params->low + 1) * sizeof(int);
+    memcpy(sortArr + params->low, &workArr[params->low], bytes);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   waits on the selected barrier
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SortEngine::phase_barrier()
+{
     switch(bartype)
     {
         case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
         case SENSE_REV_type:            sensebar->Barrier::wait(); break;
         default:                        pthreadbar->arrive_and_wait(); break;
     }
-
-
-    return NULL;
 }
+
 /*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   sorts an array by spawning threads for concurrent operation
- * 
- * @parameters  :   vector <int>&
- *                      arr         :   array to be sorted
- *                  int
- *                      nums        :   number of elements in array
- *                  size_t
- *                      numThreads  :   number of threads required for concurrent operations
+ * @brief       :   acquires the selected lock
  *
- * @returns     :   none
+ * @params      :   lockContext_t
+ *                      *ctx    :   per-thread state of the calling thread
+ * 
+ * @returns     :   None
  */
-void bucketsort(lock_algs_t alg, barrier_types_t bar, std::vector <int>& arr, int nums, size_t numThreads)
+void SortEngine::bucket_lock(lockContext_t *ctx)
 {
-    //update the list size
-    list_size = nums;
+    locktrace_begin(&lockTrace, ctx->threadId);    /*no-op unless --lock-trace was given*/
+    switch(locktype)
+    {
+        case TAS_algorithm:             taslock->TAS::TAS_lock(); break;
+        case TTAS_algorithm:            ttaslock->TTAS::TTAS_lock(); break;
+        case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_lock(); break;
+        case MCS_algorithm:             mcslock->MCS::acquire(ctx->node); break;
+        case PTHREAD_algorithm:         mutexlock->lock(); break;
+        case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_lock(ctx->threadId); break;
+        case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_lock(ctx->threadId); break;
+        case COHORT_BO_MCS_algorithm:   cbomcslock->CohortBOMCS::acquire(ctx->myNode, ctx->node); break;
+        case COHORT_TKT_TKT_algorithm:  ctktlock->CohortTktTkt::acquire(ctx->myNode); break;
+        case TIMEOUT_CLH_algorithm:     ctx->clhnode = clhlock->TimeoutCLH::acquire(); break;
+        default:                        mutexlock->lock(); break;
+    }
+    locktrace_acquired(&lockTrace, ctx->threadId);
+}
 
-    //update locking algorithm
-    locktype = alg;
-    bartype = bar; 
+/*
+ * @brief       :   tries to acquire the selected lock without waiting
+ *
+ * @params      :   lockContext_t
+ *                      *ctx    :   per-thread state of the calling thread
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool SortEngine::bucket_trylock(lockContext_t *ctx)
+{
+    bool acquired;
 
-    //determine number of buckets
-    if (list_size < 100)
+    locktrace_begin(&lockTrace, ctx->threadId);
+    switch(locktype)
     {
-        //10 buckets are sufficient for less than 100 numbers
-        num_buckets = 10;
+        case TAS_algorithm:             acquired = taslock->TAS::TAS_trylock(); break;
+        case TTAS_algorithm:            acquired = ttaslock->TTAS::TTAS_trylock(); break;
+        case TICKETLOCK_algorithm:      acquired = tktlock->TicketLock::Ticket_trylock(); break;
+        case MCS_algorithm:             acquired = mcslock->MCS::try_acquire(ctx->node); break;
+        case PTHREAD_algorithm:         acquired = mutexlock->try_lock(); break;
+        case PETERSON_SEQ_algorithm:    acquired = petersonseqlock->Peterson::sequential_trylock(ctx->threadId); break;
+        case PETERSON_REL_algorithm:    acquired = petersonrellock->Peterson::released_trylock(ctx->threadId); break;
+        case COHORT_BO_MCS_algorithm:   acquired = cbomcslock->CohortBOMCS::try_acquire(ctx->myNode, ctx->node); break;
+        case COHORT_TKT_TKT_algorithm:  acquired = ctktlock->CohortTktTkt::try_acquire(ctx->myNode); break;
+        case TIMEOUT_CLH_algorithm:     ctx->clhnode = clhlock->TimeoutCLH::try_acquire_for(chrono::nanoseconds(0));
+                                        acquired = (ctx->clhnode != NULL); break;
+        default:                        acquired = mutexlock->try_lock(); break;
     }
-    else if (list_size > 1000)
+
+    //no-op unless --lock-trace was given
+    if (acquired)
     {
-        //for high number of elements, we determine number of buckets
-        //such that on average, each bucket can accommodate 100 elements
-        //it is not necessary for each bucket to contain at most 100 elements, just an assumption
-        num_buckets = list_size / BUCKET_DIVIDER;
+        locktrace_acquired(&lockTrace, ctx->threadId);
     }
     else
     {
-        //100 buckets are sufficient for upto 1000 elements
-        num_buckets = BUCKET_DIVIDER;
+        locktrace_failed(&lockTrace, ctx->threadId);
     }
-    
-    //initialize lock
-    lock_init(alg);
-    barrier_init(numThreads, bar);  //initialize barrier
-
-    //resize the buckets vector to required number of buckets
-    buckets.resize(num_buckets);
+    return acquired;
+}
 
-    //resize the threads vector to required number of threads
-    threads.resize(numThreads);
+/*
+ * @brief       :   releases the selected lock
+ *
+ * @params      :   lockContext_t
+ *                      *ctx    :   per-thread state of the calling thread
+ * 
+ * @returns     :   None
+ */
+void SortEngine::bucket_unlock(lockContext_t *ctx)
+{
+    locktrace_release(&lockTrace, ctx->threadId);  /*no-op unless --lock-trace was given*/
+    switch(locktype)
+    {
+        case TAS_algorithm:             taslock->TAS::TAS_unlock(); break;
+        case TTAS_algorithm:            ttaslock->TTAS::TTAS_unlock(); break;
+        case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_unlock(); break;
+        case MCS_algorithm:             mcslock->MCS::release(ctx->node); break;
+        case PTHREAD_algorithm:         mutexlock->unlock(); break;
+        case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_unlock(ctx->threadId); break;
+        case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_unlock(ctx->threadId); break;
+        case COHORT_BO_MCS_algorithm:   cbomcslock->CohortBOMCS::release(ctx->myNode, ctx->node); break;
+        case COHORT_TKT_TKT_algorithm:  ctktlock->CohortTktTkt::release(ctx->myNode); break;
+        case TIMEOUT_CLH_algorithm:     clhlock->TimeoutCLH::release(ctx->clhnode); break;
+        default:                        mutexlock->unlock(); break;
+    }
+}
 
-    vector<threadParams_t> params;  //vector of threadparams structure
+/*
+ * @brief       :   determines which bucket an element belongs to
+ *
+ * @params      :   int
+ *                      num     :   element
+ * 
+ * @returns     :   int
+ *                      bucket index
+ */
+int SortEngine::bucket_index(int num)
+{
+    int bkt_idx = (int)num/num_buckets;     //determine which bucket it belongs to
 
-     int numsPerThread, //total elements per thread
-        low = 0,        //lower index of the range
-        high = 0;       //higher index of the range
-    
-    //compute number of elements per thread 
-    numsPerThread = list_size/numThreads;
+    //to avoid segmentation fault
+    if(bkt_idx >= num_buckets)
+    {
+        bkt_idx = num_buckets - 1;
+    }
+    //negative numbers go to the first bucket, same as classify_buckets()
+    if(bkt_idx < 0)
+    {
+        bkt_idx = 0;
+    }
+    return bkt_idx;
+}
 
-    for (size_t i=0; i<numThreads; i++)
+/*
+ * @brief       :   appends a staging buffer to its bucket under a single lock
+ *                  acquisition and empties it
+ *
+ * @params      :   lockContext_t
+ *                      *ctx    :   lock context of the calling thread
+ *                  Bucket&
+ *                      bucket  :   bucket the buffer belongs to
+ *                      stage   :   staged elements of that bucket
+ *                  bool
+ *                      tryOnly :   give up instead of waiting if the lock is held
+ * 
+ * @returns     :   bool
+ *                      false if the lock was held and nothing was flushed
+ */
+template <typename Bucket>
+bool SortEngine::stage_flush(lockContext_t *ctx, Bucket& bucket, Bucket& stage, bool tryOnly)
+{
+    if (tryOnly)
     {
-        //check if we are populating structure for last thread, if not
-        if (i != (numThreads-1))
+        if (!bucket_trylock(ctx))
+        {
+            //keep staging, the buffer is flushed again once it grows
+            return false;
+        }
+    }
+    else
+    {
+        bucket_lock(ctx);
+    }
+
+    bucket.insert(bucket.end(), stage.begin(), stage.end());
+
+    bucket_unlock(ctx);
+    stage.clear();
+    return true;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   sorts a range of a bucket. Ranges larger than SPLIT_THRESHOLD
+ *                  are split around their median, the upper half is pushed for
+ *                  other threads to steal and the lower half is split further.
+ *                  With --stable a bucket is never split, since splitting around
+ *                  the median moves equal keys, and it is sorted with a stable sort
+ *
+ * @params      :   WSDeque
+ *                      *mine   :   deque of the calling thread
+ *                  sortTask_t
+ *                      *task   :   range to be sorted, allocated from an arena
+ *                  vector<vector<T, ArenaAllocator<T>>>&
+ *                      bkts    :   buckets the task refers to
+ *                  Less
+ *                      less    :   order of the elements
+ * 
+ * @returns     :   None
+ */
+template <typename T, typename Less>
+void SortEngine::run_task(WSDeque *mine, sortTask_t *task, vector<vector<T, ArenaAllocator<T>>>& bkts, Less less)
+{
+    vector<T, ArenaAllocator<T>>& bkt = bkts[task->bucket];
+
+    while (!config.stable && (task->hi - task->lo > SPLIT_THRESHOLD))
+    {
+        //every element left of mid is <= every element right of it
+        int mid = task->lo + (task->hi - task->lo)/2;
+        nth_element(bkt.begin() + task->lo, bkt.begin() + mid, bkt.begin() + task->hi, less);
+
+        sortTask_t *upper = arena_new<sortTask_t>(myArena, task->bucket, mid, task->hi);
+        tasksLeft.fetch_add(1, SEQ_CST);
+        if (!mine->push(upper))
+        {
+            //deque is full, sort the upper half ourselves
+            run_task(mine, upper, bkts, less);
+        }
+        task->hi = mid;
+    }
+
+    if (config.stable)
+    {
+        stable_sort(bkt.begin() + task->lo, bkt.begin() + task->hi, less);
+    }
+    else
+    {
+        sort(bkt.begin() + task->lo, bkt.begin() + task->hi, less);
+    }
+    tasksLeft.fetch_sub(1, SEQ_CST);
+}
+
+/*
+ * @brief       :   sorts every bucket and gathers them into the array. Each
+ *                  thread pushes the buckets of its own share to its deque,
+ *                  then pops its own tasks and steals from other threads until
+ *                  every task is done. Finally each thread copies its share of
+ *                  buckets to the array, starting at the number of elements in
+ *                  the shares of lower threads
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *                  vector<vector<T, ArenaAllocator<T>>>&
+ *                      bkts        :   filled buckets
+ *                  T
+ *                      *out        :   array the sorted buckets are copied to
+ *                  Less
+ *                      less        :   order of the elements
+ * 
+ * @returns     :   None
+ */
+template <typename T, typename Less>
+void SortEngine::sortBuckets(size_t threadId, vector<vector<T, ArenaAllocator<T>>>& bkts, T *out, Less less)
+{
+    WSDeque *mine = &deques[threadId-1];
+    int low = (int)(((threadId-1) * num_buckets) / num_threads);
+    int high = (int)((threadId * num_buckets) / num_threads);
+    uint64_t tick = phase_clock();
+
+    int mySize = 0;
+    for (int b = low; b < high; b++)
+    {
+        int size = (int)bkts[b].size();
+        mySize += size;
+        if (size > 1)
+        {
+            tasksLeft.fetch_add(1, SEQ_CST);
+            sortTask_t *task = arena_new<sortTask_t>(myArena, b, 0, size);
+            if (!mine->push(task))
+            {
+                run_task(mine, task, bkts, less);
+            }
+        }
+    }
+
+    shareSize[threadId-1] = mySize;
+    phase_add(threadId, PHASE_SORT, tick);
+
+    //every thread has counted its tasks and elements before anybody checks for completion
+    phase_barrier();
+
+    //prefix sum over the shares gives the first output index of our buckets
+    int offset = 0;
+    for (size_t t = 0; t < threadId-1; t++)
+    {
+        offset += shareSize[t];
+    }
+
+    while (tasksLeft.load(SEQ_CST) > 0)
+    {
+        sortTask_t *task = mine->pop();
+
+        //own deque is empty, steal from the other threads in turn
+        for (size_t k = 1; (task == NULL) && (k < num_threads); k++)
+        {
+            task = deques[(threadId-1+k) % num_threads].steal();
+        }
+
+        if (task == NULL)
+        {
+            //remaining tasks are running on other threads
+            this_thread::yield();
+            continue;
+        }
+
+        //only the task itself is sort time, not the search for one
+        tick = phase_clock();
+        run_task(mine, task, bkts, less);
+        phase_add(threadId, PHASE_SORT, tick);
+    }
+    tick = phase_clock();
+
+    //every bucket is sorted once no task is left, copy our buckets back to the array
+    for (int b = low; b < high; b++)
+    {
+        copy(bkts[b].begin(), bkts[b].end(), out + offset);
+        offset += (int)bkts[b].size();
+    }
+    phase_add(threadId, PHASE_GATHER, tick);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   worker function for each thread
+ * 
+ * @parameters  :   threadParams_t 
+ *                      *params    :   pointer to structure containing thread params
+ *                  int* 
+ *                      arr         :   array to be sorted, a placed copy with --mem-policy or --thp
+ *
+ * @returns     :   NULL
+ */
+void* SortEngine::fillBuckets(threadParams_t* params, int* arr)
+{
+    int bkt_idx = 0;    //bucket index to store the element
+    int num=0;          //element to be stored in the bucket
+    int ids[CLASSIFY_BLOCK];    /*buckets of the current block of elements*/
+    const int *src = arr;
+    myArena = &arenas[params->threadId-1];
+    Node *thisNode = arena_new<Node>(myArena);  /*for MCS lock*/
+    vector<int> overflow;       /*elements deferred while the lock was held, with --trylock*/
+    /*staged elements per bucket, with --stage-size*/
+    vector<vector<int, ArenaAllocator<int>>> stage(config.stageSize > 0 ? num_buckets : 0, vector<int, ArenaAllocator<int>>(ArenaAllocator<int>(myArena)));
+
+    pin_thread(params->threadId);   /*no-op unless --pin or --cpus was given*/
+    place_range_in(params, false);  /*first touch of our range, with --mem-policy or --thp*/
+
+    lockContext_t ctx = {
+                            params->threadId,   //threadId
+                            thisNode,           //node
+                            NULL,               //clhnode
+                            topology_node_of_thread(params->threadId, num_threads)  //myNode
+                        };
+    perf_thread_open();         /*open counters before the timed region*/
+
+    //barrier wait here 
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+     
+    //main thread records start time here
+    if (params->threadId == 1)
+    {
+        getTime(&startTime);
+    }
+
+    //barrier wait here 
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //count events only inside the timed region
+    perf_thread_start();
+    uint64_t tick = phase_clock();
+
+    //count our elements per bucket, so that buckets are sized before any insert
+    vector<int>& hist = bucketHist[params->threadId-1];
+    for (int blk = params->low; blk <= params->high; blk += CLASSIFY_BLOCK)
+    {
+        classify_buckets(&classifier, &src[blk], min(CLASSIFY_BLOCK, params->high - blk + 1), ids, hist.data());
+    }
+    phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+    //every thread has counted its elements
+    phase_barrier();
+    tick = phase_clock();
+
+    //reserve our share of buckets, so that no insert reallocates inside the lock
+    int low = (int)(((params->threadId-1) * num_buckets) / num_threads);
+    int high = (int)((params->threadId * num_buckets) / num_threads);
+    for (int b = low; b < high; b++)
+    {
+        int total = 0;
+        for (size_t t = 0; t < num_threads; t++)
+        {
+            total += bucketHist[t][b];
+        }
+        //storage comes from our arena, it is freed with the arena
+        buckets[b] = vector<int, ArenaAllocator<int>>(ArenaAllocator<int>(myArena));
+        buckets[b].reserve(total);
+    }
+    phase_add(params->threadId, PHASE_ALLOC, tick);
+
+    //every bucket is sized before anybody inserts
+    phase_barrier();
+    tick = phase_clock();
+
+    for (int blk = params->low; blk <= params->high; blk += CLASSIFY_BLOCK)
+    {
+        int blkSize = min(CLASSIFY_BLOCK, params->high - blk + 1);
+        classify_buckets(&classifier, &src[blk], blkSize, ids, NULL);
+        tick = phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+        for (int k = 0; k < blkSize; k++)
+        {
+            num = src[blk + k];                 //get element
+            bkt_idx = ids[k];                   //bucket it belongs to, computed for the whole block
+
+            if (config.stageSize > 0)
+            {
+                //collect elements of a bucket, take the lock once per full buffer
+                stage[bkt_idx].push_back(num);
+                if ((int)stage[bkt_idx].size() % config.stageSize == 0)
+                {
+                    stage_flush(&ctx, buckets[bkt_idx], stage[bkt_idx], config.tryLock);
+                }
+            }
+            else if (config.tryLock)
+            {
+                if (bucket_trylock(&ctx))
+                {
+                    buckets[bkt_idx].push_back(num);
+
+                    //we hold the lock anyway, store the deferred elements as well
+                    for (int n : overflow)
+                    {
+                        buckets[bucket_index(n)].push_back(n);
+                    }
+                    overflow.clear();
+
+                    bucket_unlock(&ctx);
+                }
+                else
+                {
+                    //lock is busy, keep the element for later instead of spinning
+                    overflow.push_back(num);
+                }
+            }
+            else
+            {
+                //acquire lock
+                bucket_lock(&ctx);
+
+                //store element in the bucket
+                buckets[bkt_idx].push_back(num);
+
+                //release the lock
+                bucket_unlock(&ctx);
+            }
+        }
+        tick = phase_add(params->threadId, PHASE_INSERT, tick);
+    }
+
+    //flush partly filled staging buffers, waiting for the lock this time
+    for (int b = 0; b < (int)stage.size(); b++)
+    {
+        if (!stage[b].empty())
+        {
+            stage_flush(&ctx, buckets[b], stage[b], false);
+        }
+    }
+
+    //store elements still deferred, waiting for the lock this time
+    if (!overflow.empty())
+    {
+        bucket_lock(&ctx);
+        for (int n : overflow)
+        {
+            buckets[bucket_index(n)].push_back(n);
+        }
+        bucket_unlock(&ctx);
+    }
+    phase_add(params->threadId, PHASE_INSERT, tick);
+
+    //every element is in its bucket before buckets are sorted
+    phase_barrier();
+    sortBuckets(params->threadId, buckets, workArr, less<int>());
+
+    perf_thread_stop(params->threadId);
+    
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //main thread records end time here
+    if (params->threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //every range is gathered, copy ours back to the caller's array
+    place_range_out(params);
+
+    return NULL;
+}
+/*
+ * @brief       :   worker function of the radix engine. Every pass sorts by one
+ *                  RADIX_BITS wide digit, least significant first. Each thread
+ *                  counts the digits of its range, then scatters its range to
+ *                  the offsets given by a prefix sum over the counts of all
+ *                  threads. Writes go through small per-digit buffers which
+ *                  are flushed a cache line at a time
+ * 
+ * @parameters  :   threadParams_t 
+ *                      *params    :   pointer to structure containing thread params
+ *                  int* 
+ *                      arr         :   array to be sorted, a placed copy with --mem-policy or --thp
+ *
+ * @returns     :   NULL
+ */
+void* SortEngine::radixSort(threadParams_t* params, int* arr)
+{
+    int wcBuf[RADIX_BUCKETS][WC_SIZE];  /*software write-combining buffers, one per digit*/
+    int wcCount[RADIX_BUCKETS];         /*elements waiting in every buffer*/
+    int pos[RADIX_BUCKETS];             /*next output index of every digit*/
+    int ids[CLASSIFY_BLOCK];            /*digits of the current block of elements*/
+    int *src = arr;
+    int *dst = tmpArr;
+    size_t me = params->threadId - 1;
+    int scatters = 0;                   /*passes which moved the elements*/
+
+    pin_thread(params->threadId);   /*no-op unless --pin or --cpus was given*/
+    place_range_in(params, true);   /*first touch of our ranges, with --mem-policy or --thp*/
+    perf_thread_open();             /*open counters before the timed region*/
+
+    //barrier wait here 
+    phase_barrier();
+
+    //main thread records start time here
+    if (params->threadId == 1)
+    {
+        getTime(&startTime);
+    }
+
+    //barrier wait here 
+    phase_barrier();
+
+    //count events only inside the timed region
+    perf_thread_start();
+    uint64_t tick = phase_clock();
+
+    for (int shift = 0; shift < 32; shift += RADIX_BITS)
+    {
+        //counts alternate between two tables, so a thread may count the next
+        //digit while another thread still reads the previous counts
+        vector<radixHist_t>& hist = radixHist[(shift / RADIX_BITS) & 1];
+        int *mine = hist[me].count;
+
+        memset(mine, 0, sizeof(hist[me].count));
+        for (int blk = params->low; blk <= params->high; blk += CLASSIFY_BLOCK)
+        {
+            classify_digits(&classifier, &src[blk], min(CLASSIFY_BLOCK, params->high - blk + 1), shift, ids, mine);
+        }
+        phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+        //every thread has counted its range
+        phase_barrier();
+        tick = phase_clock();
+
+        //elements with a smaller digit, or the same digit in a lower thread, come first
+        int total = 0;
+        bool single = false;
+        for (int d = 0; d < RADIX_BUCKETS; d++)
+        {
+            int digitTotal = 0;
+            for (size_t t = 0; t < num_threads; t++)
+            {
+                if (t == me)
+                {
+                    pos[d] = total + digitTotal;
+                }
+                digitTotal += hist[t].count[d];
+            }
+            single = single || (digitTotal == list_size);
+            total += digitTotal;
+        }
+
+        //all elements share this digit, the pass would not move anything
+        if (single)
+        {
+            tick = phase_add(params->threadId, PHASE_ALLOC, tick);
+            continue;
+        }
+        tick = phase_add(params->threadId, PHASE_ALLOC, tick);
+
+        memset(wcCount, 0, sizeof(wcCount));
+        for (int blk = params->low; blk <= params->high; blk += CLASSIFY_BLOCK)
+        {
+            int blkSize = min(CLASSIFY_BLOCK, params->high - blk + 1);
+            classify_digits(&classifier, &src[blk], blkSize, shift, ids, NULL);
+            tick = phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+            for (int k = 0; k < blkSize; k++)
+            {
+                int d = ids[k];
+                wcBuf[d][wcCount[d]++] = src[blk + k];
+                if (wcCount[d] == WC_SIZE)
+                {
+                    memcpy(&dst[pos[d]], wcBuf[d], sizeof(wcBuf[d]));
+                    pos[d] += WC_SIZE;
+                    wcCount[d] = 0;
+                }
+            }
+            tick = phase_add(params->threadId, PHASE_INSERT, tick);
+        }
+        for (int d = 0; d < RADIX_BUCKETS; d++)
+        {
+            memcpy(&dst[pos[d]], wcBuf[d], wcCount[d] * sizeof(int));
+        }
+        phase_add(params->threadId, PHASE_INSERT, tick);
+
+        //every element is in place before it is read by the next pass
+        phase_barrier();
+        tick = phase_clock();
+        swap(src, dst);
+        scatters++;
+    }
+
+    //an odd number of scatters leaves the result in the temporary array
+    if (scatters & 1)
+    {
+        memcpy(&dst[params->low], &src[params->low], (params->high - params->low + 1) * sizeof(int));
+    }
+    phase_add(params->threadId, PHASE_GATHER, tick);
+
+    perf_thread_stop(params->threadId);
+
+    //barrier wait here
+    phase_barrier();
+
+    //main thread records end time here
+    if (params->threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    phase_barrier();
+
+    //every pass is done, copy our range back to the caller's array
+    place_range_out(params);
+
+    return NULL;
+}
+
+/*
+ * @brief       :   worker function of the mergesort engine. Each thread sorts
+ *                  its own range, then the sorted ranges of all threads are cut
+ *                  with the multiway merge path so that every thread merges the
+ *                  slice of the output with the same bounds as its range. The
+ *                  cost does not depend on the distribution of the keys
+ * 
+ * @parameters  :   threadParams_t 
+ *                      *params    :   pointer to structure containing thread params
+ *                  int* 
+ *                      arr         :   array to be sorted, a placed copy with --mem-policy or --thp
+ *
+ * @returns     :   NULL
+ */
+void* SortEngine::mergeSort(threadParams_t* params, int* arr)
+{
+    size_t k = mergeSeqs.size();
+    vector<long> lo(k), hi(k);      /*part of every sorted range merged by this thread*/
+    ArraySeqs seqs = {mergeSeqs.data(), mergeLens.data()};
+
+    pin_thread(params->threadId);   /*no-op unless --pin or --cpus was given*/
+    place_range_in(params, true);   /*first touch of our ranges, with --mem-policy or --thp*/
+    perf_thread_open();             /*open counters before the timed region*/
+
+    //barrier wait here 
+    phase_barrier();
+
+    //main thread records start time here
+    if (params->threadId == 1)
+    {
+        getTime(&startTime);
+    }
+
+    //barrier wait here 
+    phase_barrier();
+
+    //count events only inside the timed region
+    perf_thread_start();
+
+    uint64_t tick = phase_clock();
+    sort(arr + params->low, arr + params->high + 1);
+    phase_add(params->threadId, PHASE_SORT, tick);
+
+    //every range is sorted before anybody cuts them
+    phase_barrier();
+    tick = phase_clock();
+
+    multiway_split(seqs, (int)k, params->low, lo.data());
+    multiway_split(seqs, (int)k, params->high + 1, hi.data());
+    multiway_merge(mergeSeqs.data(), lo.data(), hi.data(), (int)k, tmpArr + params->low);
+    phase_add(params->threadId, PHASE_GATHER, tick);
+
+    //every slice is merged before the ranges are overwritten
+    phase_barrier();
+    tick = phase_clock();
+
+    memcpy(&arr[params->low], &tmpArr[params->low], (params->high - params->low + 1) * sizeof(int));
+    phase_add(params->threadId, PHASE_GATHER, tick);
+
+    perf_thread_stop(params->threadId);
+
+    //barrier wait here
+    phase_barrier();
+
+    //main thread records end time here
+    if (params->threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    phase_barrier();
+
+    //every slice is copied, copy our range back to the caller's array
+    place_range_out(params);
+
+    return NULL;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   number of threads sorting a list, at most one per element
+ *                  and two for Peterson's algorithm
+ * 
+ * @parameters  :   size_t
+ *                      nums        :   number of elements in the list
+ *
+ * @returns     :   size_t
+ *                      number of threads, at least 1
+ */
+size_t SortEngine::sort_threads(size_t nums)
+{
+    size_t numThreads = max((size_t)1, min(config.numThreads, nums));
+    if (config.lock == PETERSON_SEQ_algorithm || config.lock == PETERSON_REL_algorithm)
+    {
+        //peterson's algorithm supports only 2 threads
+        numThreads = min(numThreads, (size_t)2);
+    }
+    return numThreads;
+}
+
+/*
+ * @brief       :   runs a job on the pool of this sorter, the pool is created
+ *                  on first use and replaced by a bigger one if needed
+ * 
+ * @parameters  :   pool_job_t
+ *                      fn          :   job to be run, captures this sorter
+ *                  size_t
+ *                      numThreads  :   threads taking part, including the caller
+ *
+ * @returns     :   none
+ */
+void SortEngine::pool_run(pool_job_t fn, size_t numThreads)
+{
+    if (pool == NULL || pool->numThreads < numThreads)
+    {
+        pool_destroy(pool);
+        pool = pool_create(numThreads);
+    }
+    pool->run(fn, numThreads);
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   prepares a sort shared by every engine: number of buckets,
+ *                  locks, barriers, counters and the range of every thread.
+ *                  The lock and barrier are taken from config
+ * 
+ * @parameters  :   int
+ *                      nums        :   number of elements in array
+ *                  size_t
+ *                      numThreads  :   number of threads required for concurrent operations
+ *
+ * @returns     :   none
+ */
+void SortEngine::sort_setup(int nums, size_t numThreads)
+{
+    //update the list size
+    list_size = nums;
+
+    //update locking algorithm
+    locktype = config.lock;
+    bartype = config.bar; 
+
+    //determine number of buckets
+    if (list_size < 100)
+    {
+        //10 buckets are sufficient for less than 100 numbers
+        num_buckets = 10;
+    }
+    else if (list_size > 1000)
+    {
+        //for high number of elements, we determine number of buckets
+        //such that on average, each bucket can accommodate 100 elements
+        //it is not necessary for each bucket to contain at most 100 elements, just an assumption
+        num_buckets = list_size / BUCKET_DIVIDER;
+    }
+    else
+    {
+        //100 buckets are sufficient for upto 1000 elements
+        num_buckets = BUCKET_DIVIDER;
+    }
+    
+    //initialize lock
+    lock_init(locktype);
+    barrier_init(numThreads, bartype);  //initialize barrier
+    perf_init(numThreads);          //allocate per-thread counter samples
+    phase_init(numThreads);         //make room for per-thread phase times
+    locktrace_init(numThreads);     //make room for per-thread lock trace rings
+    locktrace_register(&lockTrace, locktype, 0);
+
+    //threads taking part in this sort
+    num_threads = numThreads;
+    params.clear();
+
+     int numsPerThread, //total elements per thread
+        low = 0,        //lower index of the range
+        high = 0;       //higher index of the range
+    
+    //compute number of elements per thread 
+    numsPerThread = list_size/numThreads;
+
+    for (size_t i=0; i<numThreads; i++)
+    {
+        //check if we are populating structure for last thread, if not
+        if (i != (numThreads-1))
         {
             //update the structure with computed values
             high = low + (numsPerThread - 1);
@@ -560,34 +1601,485 @@ void bucketsort(lock_algs_t alg, barrier_types_t bar, std::vector <int>& arr, in
                             });
         }
     }
+}
+
+/*
+ * @brief       :   sorts an array of ints with the engine selected in config,
+ *                  using the thread pool of this sorter
+ * 
+ * @parameters  :   int
+ *                      *arr        :   array to be sorted
+ *                  size_t
+ *                      nums        :   number of elements in array
+ *
+ * @returns     :   none
+ */
+void SortEngine::sort_int(int *arr, size_t nums)
+{
+    size_t numThreads = sort_threads(nums);
+    sort_setup((int)nums, numThreads);
 
-    //spawn threads
-    for(size_t i=1; i<numThreads; i++)
+    //empty buckets of the required number, the previous list may have left elements behind
+    buckets.assign(num_buckets, vector<int, ArenaAllocator<int>>());
+
+    sortArr = arr;
+    workArr = arr;
+    if (mem_placed())
     {
-        threads[i] = new thread(fillBuckets, &params[i], &arr);
+        //untouched copy, every thread touches its own range first
+        workArr = (int*)mem_alloc(list_size * sizeof(int));
     }
-    //master thread will also perform
-    fillBuckets(&params[0], &arr);
-    
-    //wait for threads to complete their execution and join them together
-    for(size_t i=1; i<numThreads; i++)
+    classify_init(&classifier, num_buckets, num_buckets);  /*select scalar or AVX2 classification*/
+    if (config.engine == RADIX_engine || config.engine == MERGE_engine)
+    {
+        //scatter or merge target
+        if (mem_placed())
+        {
+            tmpArr = (int*)mem_alloc(list_size * sizeof(int));
+        }
+        else
+        {
+            radixTmp.resize(list_size);
+            tmpArr = radixTmp.data();
+        }
+
+        if (config.engine == RADIX_engine)
+        {
+            //digit counts of every thread
+            radixHist[0].assign(numThreads, radixHist_t{});
+            radixHist[1].assign(numThreads, radixHist_t{});
+
+            //run radixSort on the thread pool, master thread will also perform
+            pool_run([this](size_t threadId) { return radixSort(&params[threadId-1], workArr); }, numThreads);
+        }
+        else
+        {
+            //every thread sorts its own range, these are merged afterwards
+            mergeSeqs.clear();
+            mergeLens.clear();
+            for (threadParams_t& p : params)
+            {
+                mergeSeqs.push_back(workArr + p.low);
+                mergeLens.push_back(p.high - p.low + 1);
+            }
+
+            //run mergeSort on the thread pool, master thread will also perform
+            pool_run([this](size_t threadId) { return mergeSort(&params[threadId-1], workArr); }, numThreads);
+        }
+
+        if (mem_placed())
+        {
+            mem_free(tmpArr, list_size * sizeof(int));
+        }
+    }
+    else
+    {
+        //every thread pushes its share of buckets before it pops any
+        deques_init(numThreads, (num_buckets + numThreads - 1) / numThreads);
+        arenas_init(numThreads);
+        shareSize.assign(numThreads, 0);
+        bucketHist.assign(numThreads, vector<int>(num_buckets, 0));
+
+        //run fillBuckets on the thread pool, master thread will also perform
+        pool_run([this](size_t threadId) { return fillBuckets(&params[threadId-1], workArr); }, numThreads);
+        deques_delete(numThreads);  /*delete work-stealing deques*/
+
+        //bucket storage lives in the arenas, drop it before they are released
+        buckets.clear();
+        arenas_delete(numThreads);  /*release bucket storage, nodes and tasks at once*/
+    }
+
+    if (mem_placed())
     {
-        threads[i]->join();
-        delete threads[i];
+        mem_free(workArr, list_size * sizeof(int));
     }
 
-    lock_delete(alg);       /*delete locks*/
-    barrier_delete(bar);    /*delete barrier*/
+    lock_delete(locktype);  /*delete locks*/
+    barrier_delete(bartype);    /*delete barrier*/
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   worker function of the generic bucket sort. Works like
+ *                  fillBuckets() on any key type or record: the key range of
+ *                  the input is found first, so that the bucket policy can be
+ *                  set up, then elements are counted, inserted under the lock
+ *                  and sorted by work stealing. With --stable, every thread
+ *                  writes its elements without a lock from its own offset in
+ *                  every bucket, the offset being the count of lower threads,
+ *                  so every bucket holds its elements in input order
+ * 
+ * @parameters  :   threadParams_t 
+ *                      *params    :   pointer to structure containing thread params
+ *                  T* 
+ *                      arr         :   array to be sorted
+ *                  vector<vector<T, ArenaAllocator<T>>>&
+ *                      bkts        :   buckets of this sort
+ *
+ * @returns     :   NULL
+ */
+template <typename T, typename BucketOf>
+void* SortEngine::fillBuckets_generic(threadParams_t* params, T* arr, vector<vector<T, ArenaAllocator<T>>>& bkts)
+{
+    size_t me = params->threadId - 1;
+    BucketOf bucketOf;          /*bucket function, same on every thread*/
+    myArena = &arenas[me];
+    Node *thisNode = arena_new<Node>(myArena);  /*for MCS lock*/
+    vector<T> overflow;         /*elements deferred while the lock was held, with --trylock*/
+    /*staged elements per bucket, with --stage-size*/
+    vector<vector<T, ArenaAllocator<T>>> stage(config.stageSize > 0 ? num_buckets : 0, vector<T, ArenaAllocator<T>>(ArenaAllocator<T>(myArena)));
+
+    pin_thread(params->threadId);   /*no-op unless --pin or --cpus was given*/
+
+    lockContext_t ctx = {
+                            params->threadId,   //threadId
+                            thisNode,           //node
+                            NULL,               //clhnode
+                            topology_node_of_thread(params->threadId, num_threads)  //myNode
+                        };
+    perf_thread_open();         /*open counters before the timed region*/
+
+    //barrier wait here 
+    phase_barrier();
 
-    //populate final array 
-    int bkt_idx = 0;
-    for(int i =0; i<num_buckets; i++)
+    //main thread records start time here
+    if (params->threadId == 1)
     {
-        for(int j:buckets[i])
+        getTime(&startTime);
+    }
+
+    //barrier wait here 
+    phase_barrier();
+
+    //count events only inside the timed region
+    perf_thread_start();
+    uint64_t tick = phase_clock();
+
+    //key range of our elements
+    uint64_t lo = UINT64_MAX;
+    uint64_t hi = 0;
+    for (int i = params->low; i <= params->high; i++)
+    {
+        uint64_t bits = sort_bits(arr[i]);
+        lo = min(lo, bits);
+        hi = max(hi, bits);
+    }
+    keyMin[me] = lo;
+    keyMax[me] = hi;
+    phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+    //every thread has its key range
+    phase_barrier();
+    tick = phase_clock();
+
+    for (size_t t = 0; t < num_threads; t++)
+    {
+        lo = min(lo, keyMin[t]);
+        hi = max(hi, keyMax[t]);
+    }
+    bucketOf.init(lo, hi, num_buckets);
+
+    //count our elements per bucket, so that buckets are sized before any insert
+    vector<int>& hist = bucketHist[me];
+    for (int i = params->low; i <= params->high; i++)
+    {
+        hist[bucketOf(sort_bits(arr[i]))]++;
+    }
+    phase_add(params->threadId, PHASE_CLASSIFY, tick);
+
+    //every thread has counted its elements
+    phase_barrier();
+    tick = phase_clock();
+
+    //reserve our share of buckets, so that no insert reallocates inside the lock
+    int low = (int)((me * num_buckets) / num_threads);
+    int high = (int)(((me + 1) * num_buckets) / num_threads);
+    for (int b = low; b < high; b++)
+    {
+        int total = 0;
+        for (size_t t = 0; t < num_threads; t++)
+        {
+            total += bucketHist[t][b];
+        }
+        bkts[b] = vector<T, ArenaAllocator<T>>(ArenaAllocator<T>(myArena));
+        if (config.stable)
+        {
+            bkts[b].resize(total);
+        }
+        else
+        {
+            bkts[b].reserve(total);
+        }
+    }
+
+    //first slot of every bucket written by us, after the elements of lower threads
+    vector<int> cursor;
+    if (config.stable)
+    {
+        cursor.assign(num_buckets, 0);
+        for (size_t t = 0; t < me; t++)
+        {
+            for (int b = 0; b < num_buckets; b++)
+            {
+                cursor[b] += bucketHist[t][b];
+            }
+        }
+    }
+
+    phase_add(params->threadId, PHASE_ALLOC, tick);
+
+    //every bucket is sized before anybody inserts
+    phase_barrier();
+    tick = phase_clock();
+
+    for (int i = params->low; i <= params->high; i++)
+    {
+        int bkt_idx = bucketOf(sort_bits(arr[i]));
+
+        if (config.stable)
+        {
+            //our slots of the bucket are not written by anybody else
+            bkts[bkt_idx][cursor[bkt_idx]++] = arr[i];
+        }
+        else if (config.stageSize > 0)
+        {
+            //collect elements of a bucket, take the lock once per full buffer
+            stage[bkt_idx].push_back(arr[i]);
+            if ((int)stage[bkt_idx].size() % config.stageSize == 0)
+            {
+                stage_flush(&ctx, bkts[bkt_idx], stage[bkt_idx], config.tryLock);
+            }
+        }
+        else if (config.tryLock)
+        {
+            if (bucket_trylock(&ctx))
+            {
+                bkts[bkt_idx].push_back(arr[i]);
+
+                //we hold the lock anyway, store the deferred elements as well
+                for (const T& x : overflow)
+                {
+                    bkts[bucketOf(sort_bits(x))].push_back(x);
+                }
+                overflow.clear();
+
+                bucket_unlock(&ctx);
+            }
+            else
+            {
+                //lock is busy, keep the element for later instead of spinning
+                overflow.push_back(arr[i]);
+            }
+        }
+        else
+        {
+            bucket_lock(&ctx);
+            bkts[bkt_idx].push_back(arr[i]);
+            bucket_unlock(&ctx);
+        }
+    }
+
+    //flush partly filled staging buffers, waiting for the lock this time
+    for (int b = 0; b < (int)stage.size(); b++)
+    {
+        if (!stage[b].empty())
+        {
+            stage_flush(&ctx, bkts[b], stage[b], false);
+        }
+    }
+
+    //store elements still deferred, waiting for the lock this time
+    if (!overflow.empty())
+    {
+        bucket_lock(&ctx);
+        for (const T& x : overflow)
         {
-            arr[bkt_idx++] = j;
+            bkts[bucketOf(sort_bits(x))].push_back(x);
         }
+        bucket_unlock(&ctx);
+    }
+    phase_add(params->threadId, PHASE_INSERT, tick);
+
+    //every element is in its bucket before buckets are sorted
+    phase_barrier();
+
+    //buckets are ordered by the policy, elements within a bucket by their key
+    sortBuckets(params->threadId, bkts, arr, [](const T& a, const T& b) { return sort_bits(a) < sort_bits(b); });
+
+    perf_thread_stop(params->threadId);
+
+    //barrier wait here
+    phase_barrier();
+
+    //main thread records end time here
+    if (params->threadId == 1)
+    {
+        getTime(&endTime);
     }
+
+    //barrier wait here
+    phase_barrier();
+
+    return NULL;
+}
+
+/*
+ * @brief       :   sorts an array of any key type, or of records by their key
+ *                  field, with the lock-based bucket sort. Buckets are chosen
+ *                  by the BucketOf policy over order preserving key bits
+ * 
+ * @parameters  :   T
+ *                      *arr        :   array to be sorted
+ *                  size_t
+ *                      nums        :   number of elements in array
+ *
+ * @returns     :   none
+ */
+template <typename T, typename BucketOf>
+void SortEngine::sort_generic(T *arr, size_t nums)
+{
+    size_t numThreads = sort_threads(nums);
+    sort_setup((int)nums, numThreads);
+
+    //buckets of this element type, they live as long as the sort
+    vector<vector<T, ArenaAllocator<T>>> bkts(num_buckets);
+    keyMin.assign(numThreads, 0);
+    keyMax.assign(numThreads, 0);
+
+    //every thread pushes its share of buckets before it pops any
+    deques_init(numThreads, (num_buckets + numThreads - 1) / numThreads);
+    arenas_init(numThreads);
+    shareSize.assign(numThreads, 0);
+    bucketHist.assign(numThreads, vector<int>(num_buckets, 0));
+
+    //run the generic bucket sort on the thread pool, master thread will also perform
+    pool_run([&](size_t threadId) { return fillBuckets_generic<T, BucketOf>(&params[threadId-1], arr, bkts); }, numThreads);
+    deques_delete(numThreads);  /*delete work-stealing deques*/
+
+    //bucket storage lives in the arenas, drop it before they are released
+    bkts.clear();
+    arenas_delete(numThreads);  /*release bucket storage, nodes and tasks at once*/
+
+    lock_delete(locktype);  /*delete locks*/
+    barrier_delete(bartype);    /*delete barrier*/
 }
 /*---------------------------------------------------------------------------------*/
-/*EOF*/
\ No newline at end of file
+/*
+ * @brief       :   creates a sorter with its own buckets, locks, barriers and
+ *                  thread pool. The workers are started by the first sort
+ * 
+ * @parameters  :   const sorterConfig_t&
+ *                      config      :   settings of the sorts, may be changed
+ *                                      between sorts
+ *
+ * @returns     :   Sorter*
+ *                      new sorter, deleted with sorter_delete()
+ */
+Sorter* sorter_init(const sorterConfig_t& config)
+{
+    Sorter *s = new Sorter;
+    s->config = config;
+    s->impl = new SortEngine;
+    s->impl->pool = NULL;
+    return s;
+}
+
+/*
+ * @brief       :   stops the workers of a sorter and deletes it
+ * 
+ * @parameters  :   Sorter
+ *                      *s          :   sorter to be deleted, may be NULL
+ *
+ * @returns     :   none
+ */
+void sorter_delete(Sorter *s)
+{
+    if (s == NULL)
+    {
+        return;
+    }
+    pool_destroy(s->impl->pool);
+    delete s->impl;
+    delete s;
+}
+
+/*perf counters, phase times and lock traces are tables of the process, held
+  by a sort which records any of them*/
+static mutex diagBusy;
+
+/*
+ * @brief       :   sorts data in place with the settings in config. Ints use
+ *                  the selected engine, other key types and records use the
+ *                  generic bucket sort. Sorts of one sorter are serialized,
+ *                  sorts of different sorters run at the same time unless
+ *                  --perf, --phases or --lock-trace is on
+ * 
+ * @parameters  :   std::span<T>
+ *                      data        :   elements to be sorted
+ *
+ * @returns     :   none
+ */
+template <typename T>
+void Sorter::sort(std::span<T> data)
+{
+    lock_guard<mutex> guard(busy);
+    if (data.empty())
+    {
+        return;
+    }
+    unique_lock<mutex> diagGuard(diagBusy, defer_lock);
+    if (perfFlag || phaseFlag || lockTraceFlag)
+    {
+        diagGuard.lock();
+    }
+
+    impl->config = config;
+    if constexpr (is_same<T, int>::value)
+    {
+        impl->sort_int(data.data(), data.size());
+    }
+    else
+    {
+        impl->sort_generic<T, RangeBuckets>(data.data(), data.size());
+    }
+    startTime = impl->startTime;
+    endTime = impl->endTime;
+}
+
+/*
+ * @brief       :   runs a job on the pool of this sorter, for work around the
+ *                  sorts such as the merge of an external sort. Serialized with
+ *                  the sorts of this sorter
+ * 
+ * @parameters  :   pool_job_t
+ *                      fn          :   job to be run
+ *                  size_t
+ *                      numThreads  :   threads taking part, including the caller
+ *
+ * @returns     :   none
+ */
+void Sorter::run(pool_job_t fn, size_t numThreads)
+{
+    lock_guard<mutex> guard(busy);
+    impl->pool_run(fn, numThreads);
+}
+
+/*key types and records a sorter is built for, add a line for a new type*/
+#define SORTER_TYPE(...) \
+    template void Sorter::sort<__VA_ARGS__>(std::span<__VA_ARGS__>)
+
+SORTER_TYPE(int);
+SORTER_TYPE(uint32_t);
+SORTER_TYPE(int64_t);
+SORTER_TYPE(uint64_t);
+SORTER_TYPE(float);
+SORTER_TYPE(double);
+SORTER_TYPE(record<int64_t, 8>);
+SORTER_TYPE(record<int64_t, 16>);
+SORTER_TYPE(record<int64_t, 24>);
+SORTER_TYPE(record<int64_t, 32>);
+SORTER_TYPE(record<uint64_t, 8>);
+SORTER_TYPE(record<uint64_t, 16>);
+SORTER_TYPE(record<uint64_t, 24>);
+SORTER_TYPE(record<uint64_t, 32>);
+/*---------------------------------------------------------------------------------*/
+/*EOF*/
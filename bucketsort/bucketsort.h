@@ -15,15 +15,159 @@
 #include <fstream>
 #include <cstdint>
 #include <cstring>
-#include <set>
+#include <algorithm>
 #include <string>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <barrier>
+#include <span>
+#include <ctime>
 
 #include "locks.h"
+#include "threadpool.h"
 
-void bucketsort(lock_algs_t alg, barrier_types_t bar, std::vector <int>& arr, int nums, size_t numThreads);
+/*ENUMERATED LIST OF ALL AVAILABLE SORTING ENGINES*/
+typedef enum sort_engines
+{
+    BUCKET_engine = 0,      /*threads insert into buckets under a lock, buckets are sorted by work stealing*/
+    RADIX_engine,           /*lock-free parallel LSD radix sort*/
+    MERGE_engine            /*threads sort their ranges, then merge them with a loser tree*/
+}sort_engines_t;
+
+/*settings of a sorter, the defaults are those of the command line*/
+typedef struct sorterConfig
+{
+    sort_engines_t engine = BUCKET_engine;  /*--engine*/
+    lock_algs_t lock = PTHREAD_algorithm;   /*--lock, used by the bucket engines*/
+    barrier_types_t bar = PTHREAD_type;     /*--bar, between the phases of every engine*/
+    size_t numThreads = 1;                  /*-t, threads of every sort including the caller*/
+    bool tryLock = false;                   /*--trylock, defer elements instead of spinning on a held lock*/
+    int stageSize = 0;                      /*--stage-size, elements staged per bucket before one locked flush*/
+    bool stable = false;                    /*--stable, equal keys keep their input order*/
+}sorterConfig_t;
+
+/*---------------------------------------------------------------------------------*/
+/*order preserving map of a key to an unsigned integer of the same width, so that
+  every key type is compared and bucketed as unsigned bits*/
+template <typename K>
+struct key_bits;
+
+template <>
+struct key_bits<int32_t>
+{
+    static uint32_t get(int32_t k)  { return (uint32_t)k ^ 0x80000000u; }
+};
+
+template <>
+struct key_bits<uint32_t>
+{
+    static uint32_t get(uint32_t k) { return k; }
+};
+
+template <>
+struct key_bits<int64_t>
+{
+    static uint64_t get(int64_t k)  { return (uint64_t)k ^ 0x8000000000000000ull; }
+};
+
+template <>
+struct key_bits<uint64_t>
+{
+    static uint64_t get(uint64_t k) { return k; }
+};
+
+/*negative floats have all bits flipped, positive ones only the sign bit, NaNs sort last*/
+template <>
+struct key_bits<float>
+{
+    static uint32_t get(float k)
+    {
+        uint32_t b;
+        memcpy(&b, &k, sizeof(b));
+        return (b & 0x80000000u) ? ~b : (b | 0x80000000u);
+    }
+};
+
+template <>
+struct key_bits<double>
+{
+    static uint64_t get(double k)
+    {
+        uint64_t b;
+        memcpy(&b, &k, sizeof(b));
+        return (b & 0x8000000000000000ull) ? ~b : (b | 0x8000000000000000ull);
+    }
+};
+
+/*fixed-size record sorted by its key field, the payload moves with the key*/
+template <typename K, size_t P>
+struct record
+{
+    K key;
+    unsigned char payload[P];
+};
+
+/*key of an element, plain keys are their own key*/
+template <typename T>
+inline T key_of(const T& v)                     { return v; }
+
+template <typename K, size_t P>
+inline K key_of(const record<K, P>& r)          { return r.key; }
+
+/*bits used to order and bucket an element*/
+template <typename T>
+inline uint64_t sort_bits(const T& v)           { return key_bits<decltype(key_of(v))>::get(key_of(v)); }
+
+/*Bucket function policy: splits the range [min, max] of the key bits found in the
+  input into equal power-of-two sized slices. A policy provides init() and
+  operator(), which must be monotonic and return a bucket below numBuckets*/
+class RangeBuckets
+{
+    public:
+        uint64_t min;       /*smallest key bits of the input*/
+        int shift;          /*key bits dropped to get the bucket*/
+
+        void init(uint64_t lo, uint64_t hi, int numBuckets)
+        {
+            min = lo;
+            shift = 0;
+            while (shift < 64 && ((hi - lo) >> shift) >= (uint64_t)numBuckets)
+            {
+                shift++;
+            }
+        }
+
+        int operator()(uint64_t bits) const
+        {
+            return (shift >= 64) ? 0 : (int)((bits - min) >> shift);
+        }
+};
+
+/*---------------------------------------------------------------------------------*/
+class SortEngine;   /*buckets, locks, barriers and thread pool of a sorter, defined in bucketsort.cpp*/
+
+/*Sorter class definition. A sorter owns all state of its sorts, so that sorters
+  on different threads can sort at the same time and the application can be
+  linked as a library. Sorts of one sorter are serialized. --perf, --phases and
+  --lock-trace record into tables of the process and are meant for the command
+  line: while one of them is on, sorts of all sorters run one at a time*/
+class Sorter
+{
+    public:
+        sorterConfig_t config;                  /*settings of the next sort*/
+        struct timespec startTime, endTime;     /*timed region of the last sort*/
+        SortEngine *impl;                       /*state of the sorts*/
+        std::mutex busy;                        /*held while a sort runs*/
+
+        template <typename T>
+        void sort(std::span<T> data);   //defined in bucketsort.cpp for int, the generic key types and records
+
+        void run(pool_job_t fn, size_t numThreads);     //defined in bucketsort.cpp
+};
+
+Sorter* sorter_init(const sorterConfig_t& config);
+
+void sorter_delete(Sorter *s);
 
 #endif /*_BUCKET_SORT_H_*/
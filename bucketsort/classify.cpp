@@ -0,0 +1,263 @@
+/*
+ *  @fileName       :   classify.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "classify.h"
+
+using namespace std;
+
+/*Private defines and macros*/
+#define DIGIT_MASK  (0xFF)          /*digits of the radix engine are 8 bits wide*/
+#define SIGN_FLIP   (0x80000000u)   /*makes negative numbers sort first as unsigned keys*/
+
+/*Global variables*/
+bool simdFlag = true;                   /*use AVX2 kernels if the cpu has them*/
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   computes buckets of n elements one at a time
+ *
+ * @params      :   const classifier_t
+ *                      *c      :   divisor of the sort
+ *                  const int
+ *                      *src    :   elements
+ *                  int
+ *                      n       :   number of elements
+ *                      *ids    :   bucket of every element is stored here
+ *                      *hist   :   count of every bucket is incremented, may be NULL
+ * 
+ * @returns     :   None
+ */
+static void buckets_scalar(const classifier_t *c, const int *src, int n, int *ids, int *hist)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int b = src[i] / c->divisor;
+        b = (b < 0) ? 0 : ((b > c->maxBucket) ? c->maxBucket : b);
+        ids[i] = b;
+        if (hist != NULL)
+        {
+            hist[b]++;
+        }
+    }
+}
+
+/*
+ * @brief       :   computes digits of n elements one at a time
+ *
+ * @params      :   const int
+ *                      *src    :   elements
+ *                  int
+ *                      n       :   number of elements
+ *                      shift   :   position of the digit
+ *                      *ids    :   digit of every element is stored here
+ *                      *hist   :   count of every digit is incremented, may be NULL
+ * 
+ * @returns     :   None
+ */
+static void digits_scalar(const int *src, int n, int shift, int *ids, int *hist)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int d = (int)((((unsigned int)src[i]) ^ SIGN_FLIP) >> shift) & DIGIT_MASK;
+        ids[i] = d;
+        if (hist != NULL)
+        {
+            hist[d]++;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   computes buckets of n elements, 8 at a time. The quotient is
+ *                  computed by multiplying with the reciprocal in double
+ *                  precision, which is off by at most one, and corrected with
+ *                  an integer multiply
+ *
+ * @params      :   same as buckets_scalar()
+ * 
+ * @returns     :   None
+ */
+__attribute__((target("avx2")))
+static void buckets_avx2(const classifier_t *c, const int *src, int n, int *ids, int *hist)
+{
+    const __m256d inv = _mm256_set1_pd(c->inverse);
+    const __m256i d = _mm256_set1_epi32(c->divisor);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i top = _mm256_set1_epi32(c->maxBucket);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&src[i]);
+
+        //q = trunc(x / divisor), computed on two halves of 4 lanes
+        __m128i qlo = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), inv));
+        __m128i qhi = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), inv));
+        __m256i q = _mm256_inserti128_si256(_mm256_castsi128_si256(qlo), qhi, 1);
+
+        //remainder tells whether the rounded quotient is one off
+        __m256i r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, d));
+        q = _mm256_sub_epi32(q, _mm256_and_si256(_mm256_cmpgt_epi32(zero, r), one));
+        q = _mm256_add_epi32(q, _mm256_andnot_si256(_mm256_cmpgt_epi32(d, r), one));
+
+        //clamp to [0, maxBucket]
+        q = _mm256_min_epi32(_mm256_max_epi32(q, zero), top);
+        _mm256_storeu_si256((__m256i*)&ids[i], q);
+    }
+    buckets_scalar(c, &src[i], n - i, &ids[i], NULL);
+
+    //scattered increments do not vectorize, count from the stored ids
+    if (hist != NULL)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            hist[ids[k]]++;
+        }
+    }
+}
+
+/*
+ * @brief       :   computes digits of n elements, 8 at a time
+ *
+ * @params      :   same as digits_scalar()
+ * 
+ * @returns     :   None
+ */
+__attribute__((target("avx2")))
+static void digits_avx2(const int *src, int n, int shift, int *ids, int *hist)
+{
+    const __m256i flip = _mm256_set1_epi32((int)SIGN_FLIP);
+    const __m256i mask = _mm256_set1_epi32(DIGIT_MASK);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&src[i]);
+        __m256i dgt = _mm256_and_si256(_mm256_srl_epi32(_mm256_xor_si256(x, flip), count), mask);
+        _mm256_storeu_si256((__m256i*)&ids[i], dgt);
+    }
+    digits_scalar(&src[i], n - i, shift, &ids[i], NULL);
+
+    if (hist != NULL)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            hist[ids[k]]++;
+        }
+    }
+}
+#endif
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   sets the divisor of the bucket kernel and selects the AVX2
+ *                  kernels if the cpu supports them and --no-simd was not given
+ *
+ * @params      :   classifier_t
+ *                      *c          :   classifier of one sort
+ *                  int
+ *                      div         :   bucket of num is num / div
+ *                      numBuckets  :   number of buckets, larger quotients go
+ *                                      to the last bucket
+ * 
+ * @returns     :   None
+ */
+void classify_init(classifier_t *c, int div, int numBuckets)
+{
+    c->divisor = div;
+    c->maxBucket = numBuckets - 1;
+    c->inverse = 1.0 / (double)div;
+
+    c->simd = false;
+#if defined(__x86_64__) || defined(__i386__)
+    if (simdFlag && __builtin_cpu_supports("avx2"))
+    {
+        c->simd = true;
+    }
+#endif
+}
+
+/*
+ * @brief       :   tells whether the AVX2 kernels were selected
+ *
+ * @params      :   const classifier_t
+ *                      *c      :   classifier of one sort
+ * 
+ * @returns     :   bool
+ *                      true if AVX2 kernels are used
+ */
+bool classify_uses_simd(const classifier_t *c)
+{
+    return c->simd;
+}
+
+/*
+ * @brief       :   computes the bucket of n elements and counts them per bucket
+ *
+ * @params      :   const classifier_t
+ *                      *c      :   classifier of one sort
+ *                  const int
+ *                      *src    :   elements
+ *                  int
+ *                      n       :   number of elements
+ *                      *ids    :   bucket of every element is stored here
+ *                      *hist   :   count of every bucket is incremented, may be NULL
+ * 
+ * @returns     :   None
+ */
+void classify_buckets(const classifier_t *c, const int *src, int n, int *ids, int *hist)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (c->simd)
+    {
+        buckets_avx2(c, src, n, ids, hist);
+        return;
+    }
+#endif
+    buckets_scalar(c, src, n, ids, hist);
+}
+
+/*
+ * @brief       :   computes an 8-bit radix digit of n elements and counts them
+ *                  per digit
+ *
+ * @params      :   const classifier_t
+ *                      *c      :   classifier of one sort
+ *                  const int
+ *                      *src    :   elements
+ *                  int
+ *                      n       :   number of elements
+ *                      shift   :   position of the digit
+ *                      *ids    :   digit of every element is stored here
+ *                      *hist   :   count of every digit is incremented, may be NULL
+ * 
+ * @returns     :   None
+ */
+void classify_digits(const classifier_t *c, const int *src, int n, int shift, int *ids, int *hist)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (c->simd)
+    {
+        digits_avx2(src, n, shift, ids, hist);
+        return;
+    }
+#endif
+    digits_scalar(src, n, shift, ids, hist);
+}
+
+/*EOF*/
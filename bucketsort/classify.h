@@ -0,0 +1,38 @@
+/*
+ *  @fileName       :   classify.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _CLASSIFY_H_
+#define _CLASSIFY_H_
+
+#include <iostream>
+#include <cstdbool>
+
+/*GLOBAL DEFINES*/
+#define CLASSIFY_BLOCK  (256)   /*elements classified per call by the sorting engines*/
+
+/*bucket divisor and kernels of one sort, set up by classify_init()*/
+typedef struct classifier
+{
+    int divisor;        /*bucket of num is num / divisor*/
+    int maxBucket;      /*last bucket, larger quotients are clamped*/
+    double inverse;     /*1 / divisor, for the vector division*/
+    bool simd;          /*AVX2 kernels are used*/
+}classifier_t;
+
+extern bool simdFlag;           /*cleared by --no-simd, AVX2 kernels are used if the cpu has them*/
+
+void classify_init(classifier_t *c, int divisor, int numBuckets);
+
+bool classify_uses_simd(const classifier_t *c);
+
+void classify_buckets(const classifier_t *c, const int *src, int n, int *ids, int *hist);
+
+void classify_digits(const classifier_t *c, const int *src, int n, int shift, int *ids, int *hist);
+
+#endif /*_CLASSIFY_H_*/
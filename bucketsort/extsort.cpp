@@ -0,0 +1,467 @@
+/*
+ *  @fileName       :   extsort.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "extsort.h"
+#include "bucketsort.h"
+#include "phasetimer.h"
+
+using namespace std;
+
+/*Private typedefs, classes, structs and unions*/
+/*sorted run spilled to an unlinked temporary file*/
+typedef struct run
+{
+    int fd;
+    long size;                              /*elements in the run*/
+    long classStart[EXT_LINE_CLASSES + 1];  /*first element of every line length class, then size*/
+}run_t;
+
+/*spilled runs as seen by multiway_split()*/
+class RunSeqs
+{
+    public:
+        std::vector<run_t> *runs;
+
+        long size(int i)        { return (*runs)[i].size; }
+        int at(int i, long j);  //defined below
+};
+
+/*state of one external sort, so that external sorts on different threads do
+  not share anything*/
+typedef struct extSort
+{
+    vector<run_t> runs;             /*every run spilled so far*/
+    vector<vector<long>> cuts;      /*cuts[p][r] is the first element of run r merged by thread p+1*/
+    vector<long> offsets;           /*first byte of the text of every merging thread, then the size of the output*/
+    size_t bufElems;                /*elements per read buffer of every run reader*/
+    int outFd;                      /*output file, written by every merging thread at its offset*/
+}extSort_t;
+
+/*Global variables*/
+/*smallest value of every line length class, a sorted run holds every class in
+  one contiguous range*/
+static const int lineClasses[EXT_LINE_CLASSES] =
+{
+    INT_MIN, -999999999, -99999999, -9999999, -999999, -99999, -9999, -999, -99, -9,
+    0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   creates an unlinked temporary file in $TMPDIR or /tmp, the
+ *                  file is removed by the system once it is closed
+ *
+ * @params      :   None
+ *
+ * @returns     :   int
+ *                      file descriptor, exits with EXIT_FAILURE on failure
+ */
+static int temp_open()
+{
+    const char *dir = getenv("TMPDIR");
+    string path = string((dir != NULL) ? dir : "/tmp") + "/mysort-XXXXXX";
+    vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    int fd = mkstemp(name.data());
+    if (fd < 0)
+    {
+        cout << "Failed to create temporary file, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+    unlink(name.data());
+    return fd;
+}
+
+/*
+ * @brief       :   writes a whole buffer at an offset of a file, retrying short
+ *                  writes. Threads may write disjoint ranges of one file
+ *
+ * @params      :   int
+ *                      fd      :   file to be written
+ *                  const void
+ *                      *data   :   buffer
+ *                  size_t
+ *                      bytes   :   size of the buffer
+ *                  long
+ *                      offset  :   first byte of the file to be written
+ *
+ * @returns     :   None, exits with EXIT_FAILURE on failure
+ */
+static void write_at(int fd, const void *data, size_t bytes, long offset)
+{
+    const char *p = (const char*)data;
+    while (bytes > 0)
+    {
+        ssize_t n = pwrite(fd, p, bytes, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            cout << "Failed to write file, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        p += n;
+        bytes -= n;
+        offset += n;
+    }
+}
+
+/*
+ * @brief       :   length of the output line of a value, with the newline
+ *
+ * @params      :   int
+ *                      val     :   value
+ *
+ * @returns     :   long
+ *                      bytes of the line
+ */
+static long line_bytes(int val)
+{
+    char text[EXT_LINE_BYTES];
+    return (to_chars(text, text + sizeof(text), val).ptr - text) + 1;
+}
+
+/*
+ * @brief       :   reads one element of a run
+ *
+ * @params      :   run_t
+ *                      *r      :   run to be read
+ *                  long
+ *                      i       :   index of the element
+ *
+ * @returns     :   int
+ *                      element
+ */
+static int run_at(run_t *r, long i)
+{
+    int val = 0;
+    if (pread(r->fd, &val, sizeof(val), i * sizeof(int)) != sizeof(val))
+    {
+        cout << "Failed to read temporary file, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+    return val;
+}
+
+/*
+ * @brief       :   reads one element of a spilled run, for multiway_split()
+ *
+ * @params      :   int
+ *                      i       :   run
+ *                  long
+ *                      j       :   index of the element in the run
+ *
+ * @returns     :   int
+ *                      element
+ */
+int RunSeqs::at(int i, long j)
+{
+    return run_at(&(*runs)[i], j);
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   returns the next element of the range, refilling the buffer
+ *                  with one large read when it is empty
+ *
+ * @params      :   int&
+ *                      val     :   next element
+ *
+ * @returns     :   bool
+ *                      false once the range is exhausted
+ */
+bool RunReader::read(int& val)
+{
+    if (next == len)
+    {
+        if (pos >= end)
+        {
+            return false;
+        }
+        size_t want = min((long)buf.size(), end - pos);
+        ssize_t got = pread(fd, buf.data(), want * sizeof(int), pos * sizeof(int));
+        if (got < (ssize_t)sizeof(int))
+        {
+            cout << "Failed to read temporary file, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        len = got / sizeof(int);
+        next = 0;
+        pos += len;
+    }
+    val = buf[next++];
+    return true;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   reads the input chunk by chunk, sorts every chunk and spills
+ *                  it as a binary run. The start of every line length class is
+ *                  found while the chunk is still in memory
+ *
+ * @params      :   extSort_t
+ *                      *ext        :   external sort
+ *                  string
+ *                      inputFile   :   path to the input
+ *                  size_t
+ *                      chunkElems  :   elements per chunk
+ *                      readBytes   :   size of the input buffer
+ *                  chunk_sort_t
+ *                      sortChunk   :   in-memory sort of one chunk
+ *
+ * @returns     :   None, exits with EXIT_FAILURE if file opening fails
+ */
+static void make_runs(extSort_t *ext, string inputFile, size_t chunkElems, size_t readBytes, chunk_sort_t sortChunk)
+{
+    ifstream fin;
+    vector<char> readBuf(readBytes);    /*large sequential reads of the input*/
+    fin.rdbuf()->pubsetbuf(readBuf.data(), readBuf.size());
+    fin.open(inputFile);
+    if(!fin)
+    {
+        cout << "Failed to open file, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<int> chunk;
+    chunk.reserve(chunkElems);
+    int val;
+    while (true)
+    {
+        chunk.clear();
+        while (chunk.size() < chunkElems && (fin >> val))
+        {
+            chunk.push_back(val);
+        }
+        if (chunk.empty())
+        {
+            break;
+        }
+
+        sortChunk(chunk);
+
+        run_t r;
+        r.fd = temp_open();
+        r.size = (long)chunk.size();
+        for (int c = 0; c < EXT_LINE_CLASSES; c++)
+        {
+            r.classStart[c] = lower_bound(chunk.begin(), chunk.end(), lineClasses[c]) - chunk.begin();
+        }
+        r.classStart[EXT_LINE_CLASSES] = r.size;
+        write_at(r.fd, chunk.data(), chunk.size() * sizeof(int), 0);
+        ext->runs.push_back(r);
+    }
+    fin.close();
+}
+
+/*
+ * @brief       :   cuts every run with the multiway merge path, so that every
+ *                  thread merges the same number of elements and thread p+1
+ *                  writes the slice [p*n/numParts, (p+1)*n/numParts) of the
+ *                  output. The text of every slice starts where the text of the
+ *                  slices before it ends
+ *
+ * @params      :   extSort_t
+ *                      *ext        :   external sort
+ *                  size_t
+ *                      numParts    :   number of merging threads
+ *
+ * @returns     :   None
+ */
+static void cut_runs(extSort_t *ext, size_t numParts)
+{
+    vector<run_t>& runs = ext->runs;
+    RunSeqs seqs = {&runs};
+    long total = 0;
+    for (run_t& r : runs)
+    {
+        total += r.size;
+    }
+
+    ext->cuts.assign(numParts + 1, vector<long>(runs.size(), 0));
+    for (size_t p = 1; p <= numParts; p++)
+    {
+        multiway_split(seqs, (int)runs.size(), (long)((p * total) / numParts), ext->cuts[p].data());
+    }
+
+    //bytes of a range of a run, from the overlap with every line length class
+    ext->offsets.assign(numParts + 1, 0);
+    for (size_t p = 0; p < numParts; p++)
+    {
+        long bytes = 0;
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            long lo = ext->cuts[p][i];
+            long hi = ext->cuts[p+1][i];
+            for (int c = 0; c < EXT_LINE_CLASSES; c++)
+            {
+                long from = max(lo, runs[i].classStart[c]);
+                long to = min(hi, runs[i].classStart[c+1]);
+                if (to > from)
+                {
+                    bytes += (to - from) * line_bytes(lineClasses[c]);
+                }
+            }
+        }
+        ext->offsets[p+1] = ext->offsets[p] + bytes;
+    }
+}
+
+/*
+ * @brief       :   job run by every thread of the pool, merges its part of
+ *                  every run with a loser tree and writes the result as text
+ *                  straight into its range of the output file
+ *
+ * @params      :   extSort_t
+ *                      *ext        :   external sort
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   NULL
+ */
+static void* merge_job(extSort_t *ext, size_t threadId)
+{
+    vector<run_t>& runs = ext->runs;
+    vector<vector<long>>& cuts = ext->cuts;
+    size_t bufElems = ext->bufElems;
+    size_t p = threadId - 1;
+    size_t k = runs.size();
+    uint64_t tick = phase_clock();
+    vector<RunReader> readers(k);
+    LoserTree tree;
+    tree.key.assign(k, 0);
+    tree.done.assign(k, true);
+
+    for (size_t r = 0; r < k; r++)
+    {
+        readers[r].fd = runs[r].fd;
+        readers[r].pos = cuts[p][r];
+        readers[r].end = cuts[p+1][r];
+        readers[r].buf.resize(bufElems);
+        readers[r].next = 0;
+        readers[r].len = 0;
+
+        int val;
+        if (readers[r].read(val))
+        {
+            tree.key[r] = val;
+            tree.done[r] = false;
+        }
+    }
+    tree.init(k);
+
+    //one line per element
+    vector<char> out(bufElems * EXT_LINE_BYTES);
+    size_t used = 0;
+    long offset = ext->offsets[p];
+
+    while (!tree.done[tree.node[0]])
+    {
+        int src = tree.node[0];
+        if (used + EXT_LINE_BYTES > out.size())
+        {
+            write_at(ext->outFd, out.data(), used, offset);
+            offset += used;
+            used = 0;
+        }
+        used = to_chars(out.data() + used, out.data() + out.size(), tree.key[src]).ptr - out.data();
+        out[used++] = '\n';
+
+        int val;
+        if (readers[src].read(val))
+        {
+            tree.key[src] = val;
+        }
+        else
+        {
+            tree.done[src] = true;
+        }
+        tree.replay(src);
+    }
+    write_at(ext->outFd, out.data(), used, offset);
+    phase_add(threadId, PHASE_MERGE, tick);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   sorts a file that may not fit in memory. The input is read in
+ *                  chunks, every chunk is sorted in memory and spilled to a
+ *                  temporary file as a sorted run. The runs are then split into
+ *                  one key range per thread and every thread merges its range
+ *                  with a loser tree on the pool of the sorter, writing its
+ *                  text straight into the output file
+ *
+ * @params      :   Sorter
+ *                      *sorter     :   sorter whose pool merges the runs
+ *                  string
+ *                      inputFile   :   path to the input
+ *                      outputFile  :   path to the output
+ *                  size_t
+ *                      memLimit    :   memory budget in bytes
+ *                      numThreads  :   threads merging the runs
+ *                  chunk_sort_t
+ *                      sortChunk   :   in-memory sort of one chunk
+ *
+ * @returns     :   None, exits with EXIT_FAILURE if file opening fails
+ */
+void external_sort(Sorter *sorter, string inputFile, string outputFile, size_t memLimit, size_t numThreads, chunk_sort_t sortChunk)
+{
+    extSort_t ext;
+
+    //the input buffer comes out of the budget, and the bucket sort engine keeps
+    //a second copy of a chunk in its buckets
+    size_t readBytes = min((size_t)EXT_IO_BYTES, max(EXT_MIN_BUFFER * sizeof(int), memLimit / 8));
+    size_t chunkElems = max((size_t)EXT_MIN_BUFFER, (memLimit - min(memLimit, readBytes)) / (2 * sizeof(int)));
+    make_runs(&ext, inputFile, chunkElems, readBytes, sortChunk);
+
+    size_t numParts = max((size_t)1, numThreads);
+    //every merging thread holds a read buffer per run and a text output buffer
+    ext.bufElems = max((size_t)EXT_MIN_BUFFER, memLimit / (numParts * (ext.runs.size() * sizeof(int) + EXT_LINE_BYTES)));
+
+    ext.outFd = open(outputFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (ext.outFd < 0)
+    {
+        cout << "Failed to open file, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (!ext.runs.empty())
+    {
+        cut_runs(&ext, numParts);
+        if (ftruncate(ext.outFd, ext.offsets[numParts]) != 0)
+        {
+            cout << "Failed to write file, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        phase_init(numParts);       //make room for the merge time of every thread
+        sorter->run([&ext](size_t threadId) { return merge_job(&ext, threadId); }, numParts);
+    }
+    close(ext.outFd);
+
+    for (run_t& r : ext.runs)
+    {
+        close(r.fd);
+    }
+}
+
+/*EOF*/
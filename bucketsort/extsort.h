@@ -0,0 +1,48 @@
+/*
+ *  @fileName       :   extsort.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _EXTSORT_H_
+#define _EXTSORT_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdbool>
+
+#include "merge.h"
+
+/*GLOBAL DEFINES*/
+#define EXT_MIN_BUFFER  (4096)  /*smallest read buffer of a run and output buffer of a merge, in elements*/
+#define EXT_LINE_BYTES  (12)    /*longest output line of one element, 11 characters and a newline*/
+#define EXT_LINE_CLASSES (20)   /*lengths of output lines, 2 to 11 bytes for non-negative and 3 to 12 for negative ints*/
+#define EXT_IO_BYTES    (1 << 20)   /*largest buffer of the input file*/
+
+class Sorter;   /*defined in bucketsort.h*/
+
+/*sorts one chunk of the input in memory*/
+typedef std::function<void(std::vector<int>&)> chunk_sort_t;
+
+/*buffered reader of the range [pos, end) of a sorted run*/
+class RunReader
+{
+    public:
+        int fd;                 /*file holding the run*/
+        long pos;               /*next element to be read from the file*/
+        long end;               /*one past the last element of the range*/
+        std::vector<int> buf;   /*elements read ahead*/
+        size_t next;            /*next element of buf to be returned*/
+        size_t len;             /*valid elements in buf*/
+
+        bool read(int& val);    //defined in extsort.cpp
+};
+
+void external_sort(Sorter *sorter, std::string inputFile, std::string outputFile, size_t memLimit, size_t numThreads, chunk_sort_t sortChunk);
+
+#endif /*_EXTSORT_H_*/
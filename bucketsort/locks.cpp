@@ -8,10 +8,50 @@
  */
 
 /*LIBRARY FILES*/
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
 #include "locks.h"
 
+/*PRIVATE DEFINES*/
+#define NO_TIMEOUT  (chrono::nanoseconds::max())    /*wait forever*/
+#define PF_RINC     (0x100)     /*reader increment of phase-fair lock*/
+#define PF_WBITS    (0x3)       /*writer bits of phase-fair lock*/
+#define PF_PRES     (0x2)       /*writer present*/
+#define PF_PHID     (0x1)       /*writer phase id*/
+#define MCS_OWN_NODES   (8)     /*MCS locks a thread may hold at once through lock() without allocating*/
+#define CLH_OWN_NODES   (8)     /*free CLH nodes a thread keeps for its next acquisitions*/
+
 using namespace std; 
 
+CLHNode TimeoutCLH::available;                      /*pred of a released CLH node*/
+int cohortPassBound = COHORT_DEFAULT_PASS_BOUND;    /*local handoffs before global lock is released*/
+
+/*queue nodes used by MCS::lock(), try_lock() & timed_lock() of every thread*/
+static thread_local Node mcsNodes[MCS_OWN_NODES];
+static thread_local bool mcsNodeBusy[MCS_OWN_NODES];
+
+/*free CLH nodes of a thread. A CLH node is given back by the last thread which
+  refers to it, often the successor, so nodes move between the threads*/
+class CLHNodeCache
+{
+    public:
+        CLHNode *nodes[CLH_OWN_NODES];
+        int count = 0;
+
+        ~CLHNodeCache()
+        {
+            for (int i = 0; i < count; i++)
+            {
+                delete nodes[i];
+            }
+        }
+};
+static thread_local CLHNodeCache clhNodes;
+
 /*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Aqcuires the lock using TAS method
@@ -40,6 +80,42 @@ void TAS::TAS_unlock()
 {
     taslock.store(false, SEQ_CST);
 } 
+
+/*
+ * @brief       :   Tries to acquire the lock using TAS method, without waiting
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TAS::TAS_trylock()
+{
+    bool expected = false;
+    return taslock.compare_exchange_strong(expected, true, SEQ_CST);
+}
+
+/*
+ * @brief       :   Tries to acquire the lock using TAS method until timeout
+ *
+ * @params      :   chrono::nanoseconds
+ *                      timeout :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TAS::TAS_timedlock(chrono::nanoseconds timeout)
+{
+    auto deadline = chrono::steady_clock::now() + timeout;
+    while(!TAS_trylock())
+    {
+        if (chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 /*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Aqcuires the lock using TTAS method
@@ -71,6 +147,43 @@ void TTAS::TTAS_unlock()
 {
     ttaslock.store(false, SEQ_CST);
 } 
+
+/*
+ * @brief       :   Tries to acquire the lock using TTAS method, without waiting
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TTAS::TTAS_trylock()
+{
+    bool expected = false;
+    return (ttaslock.load(SEQ_CST) == false) && 
+           ttaslock.compare_exchange_strong(expected, true, SEQ_CST);
+}
+
+/*
+ * @brief       :   Tries to acquire the lock using TTAS method until timeout
+ *
+ * @params      :   chrono::nanoseconds
+ *                      timeout :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TTAS::TTAS_timedlock(chrono::nanoseconds timeout)
+{
+    auto deadline = chrono::steady_clock::now() + timeout;
+    while(!TTAS_trylock())
+    {
+        if (chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 /*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Aqcuires the lock using Ticket lock method
@@ -96,6 +209,47 @@ void TicketLock::Ticket_unlock()
 {
     now_serving.fetch_add(1, SEQ_CST);
 } 
+
+/*
+ * @brief       :   Tries to acquire the ticket lock, a ticket is taken only if it
+ *                  would be served immediately
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TicketLock::Ticket_trylock()
+{
+    int serving = now_serving.load(SEQ_CST);
+    int expected = serving;
+    return next_num.compare_exchange_strong(expected, serving+1, SEQ_CST);
+}
+
+/*
+ * @brief       :   Tries to acquire the ticket lock until timeout. A ticket once
+ *                  taken cannot be given back, so this polls Ticket_trylock()
+ *                  and does not keep FIFO order while waiting
+ *
+ * @params      :   chrono::nanoseconds
+ *                      timeout :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TicketLock::Ticket_timedlock(chrono::nanoseconds timeout)
+{
+    auto deadline = chrono::steady_clock::now() + timeout;
+    while(!Ticket_trylock())
+    {
+        if (chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        cpu_relax();
+    }
+    return true;
+}
 /*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Aqcuires the lock using MCS lock method
@@ -150,26 +304,352 @@ void MCS::release(Node *nodeptr)
         nodeptr->next.load(SEQ_CST)->wait.store(false, SEQ_CST);
     }
 }
+
+/*
+ * @brief       :   Tries to acquire the MCS lock, succeeds only if the queue is
+ *                  empty
+ *
+ * @params      :   Node
+ *                      *nodeptr    :   pointer to current thread's node
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool MCS::try_acquire(Node *nodeptr)
+{
+    Node *expected = NULL;
+    nodeptr->next.store(NULL, RELAXED);
+    return (tail.load(SEQ_CST) == NULL) && 
+           tail.compare_exchange_strong(expected, nodeptr, SEQ_CST);
+}
+
+/*
+ * @brief       :   Tries to acquire the MCS lock until timeout. A node which is
+ *                  linked into the queue cannot leave it, so this polls
+ *                  try_acquire(), use TimeoutCLH for an abortable FIFO queue
+ *
+ * @params      :   Node
+ *                      *nodeptr    :   pointer to current thread's node
+ *                  chrono::nanoseconds
+ *                      timeout     :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool MCS::timed_acquire(Node *nodeptr, chrono::nanoseconds timeout)
+{
+    auto deadline = chrono::steady_clock::now() + timeout;
+    while(!try_acquire(nodeptr))
+    {
+        if (chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        cpu_relax();
+    }
+    return true;
+}
+
+/*
+ * @brief       :   Takes a free queue node of the calling thread. Falls back to
+ *                  the heap if the thread already holds MCS_OWN_NODES locks
+ *
+ * @params      :   None
+ * 
+ * @returns     :   Node*
+ *                      node to be given back with mcs_node_put()
+ */
+static Node* mcs_node_get()
+{
+    for (int i = 0; i < MCS_OWN_NODES; i++)
+    {
+        if (!mcsNodeBusy[i])
+        {
+            mcsNodeBusy[i] = true;
+            return &mcsNodes[i];
+        }
+    }
+    return new Node;
+}
+
+/*
+ * @brief       :   Gives back a node taken with mcs_node_get(), once no other
+ *                  thread touches it
+ *
+ * @params      :   Node
+ *                      *nodeptr    :   node to be given back
+ * 
+ * @returns     :   None
+ */
+static void mcs_node_put(Node *nodeptr)
+{
+    if (nodeptr >= &mcsNodes[0] && nodeptr < &mcsNodes[MCS_OWN_NODES])
+    {
+        mcsNodeBusy[nodeptr - &mcsNodes[0]] = false;
+    }
+    else
+    {
+        delete nodeptr;
+    }
+}
+
+/*
+ * @brief       :   Acquires the MCS lock with a node of the calling thread, for
+ *                  std::Lockable
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void MCS::lock()
+{
+    Node *nodeptr = mcs_node_get();
+    acquire(nodeptr);
+    owner = nodeptr;
+}
+
+/*
+ * @brief       :   Releases the MCS lock acquired by lock(), try_lock() or
+ *                  timed_lock()
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void MCS::unlock()
+{
+    Node *nodeptr = owner;
+    release(nodeptr);
+    mcs_node_put(nodeptr);  //no other thread touches our node after release
+}
+
+/*
+ * @brief       :   Tries to acquire the MCS lock, for std::Lockable
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool MCS::try_lock()
+{
+    return timed_lock(chrono::nanoseconds(0));
+}
+
+/*
+ * @brief       :   Tries to acquire the MCS lock until timeout, for
+ *                  std::TimedLockable
+ *
+ * @params      :   chrono::nanoseconds
+ *                      t       :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool MCS::timed_lock(chrono::nanoseconds t)
+{
+    Node *nodeptr = mcs_node_get();
+    if (!timed_acquire(nodeptr, t))
+    {
+        mcs_node_put(nodeptr);
+        return false;
+    }
+    owner = nodeptr;
+    return true;
+}
 /*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   Implements a barrier using sense reversal barrier algorithm
+ * @brief       :   Takes a free CLH node of the calling thread, or a new one if
+ *                  the thread has none left
  *
  * @params      :   None
  * 
+ * @returns     :   CLHNode*
+ *                      node to be given back with clh_node_put()
+ */
+static CLHNode* clh_node_get()
+{
+    if (clhNodes.count > 0)
+    {
+        return clhNodes.nodes[--clhNodes.count];
+    }
+    return new CLHNode;
+}
+
+/*
+ * @brief       :   Keeps a CLH node which no other thread refers to anymore for
+ *                  the next acquisition of the calling thread, frees it if the
+ *                  thread already keeps CLH_OWN_NODES nodes
+ *
+ * @params      :   CLHNode
+ *                      *nodeptr    :   node to be given back
+ * 
  * @returns     :   None
  */
-void Barrier::wait()
+static void clh_node_put(CLHNode *nodeptr)
+{
+    if (clhNodes.count < CLH_OWN_NODES)
+    {
+        clhNodes.nodes[clhNodes.count++] = nodeptr;
+    }
+    else
+    {
+        delete nodeptr;
+    }
+}
+
+/*
+ * @brief       :   Tries to acquire the timeout CLH lock until timeout. The node
+ *                  is appended to the queue and the thread spins on its
+ *                  predecessor. If the predecessor gave up, its own predecessor
+ *                  is adopted and the abandoned node is recycled. On timeout our
+ *                  node is removed from the tail if possible, otherwise it is
+ *                  left for the successor to skip
+ *
+ * @params      :   chrono::nanoseconds
+ *                      timeout :   maximum time to wait
+ * 
+ * @returns     :   CLHNode*
+ *                      node to be passed to release(), NULL on timeout
+ */
+CLHNode* TimeoutCLH::try_acquire_for(chrono::nanoseconds timeout)
+{
+    bool forever = (timeout == NO_TIMEOUT);
+    auto deadline = forever ? chrono::steady_clock::time_point::max() : chrono::steady_clock::now() + timeout;
+
+    CLHNode *nodeptr = clh_node_get();
+    nodeptr->pred.store(NULL, RELAXED);
+
+    CLHNode *myPred = tail.exchange(nodeptr, SEQ_CST);
+    if (myPred == NULL)
+    {
+        return nodeptr;     //queue was empty
+    }
+
+    unsigned int spins = 0;
+    while(true)
+    {
+        CLHNode *predPred = myPred->pred.load(SEQ_CST);
+        if (predPred == &available)
+        {
+            //predecessor released the lock, nobody else refers to its node
+            clh_node_put(myPred);
+            return nodeptr;
+        }
+        else if (predPred != NULL)
+        {
+            //predecessor timed out, skip it
+            clh_node_put(myPred);
+            myPred = predPred;
+        }
+
+        //reading the clock on every spin would slow down the handoff
+        if (!forever && ((++spins & 0x3f) == 0) && chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+
+    //timed out, leave the queue
+    CLHNode *expected = nodeptr;
+    if (tail.compare_exchange_strong(expected, myPred, SEQ_CST))
+    {
+        clh_node_put(nodeptr);      //nobody queued behind us
+    }
+    else
+    {
+        nodeptr->pred.store(myPred, SEQ_CST);   //successor will skip and recycle our node
+    }
+    return NULL;
+}
+
+/*
+ * @brief       :   Aqcuires the timeout CLH lock, waiting as long as needed
+ *
+ * @params      :   None
+ * 
+ * @returns     :   CLHNode*
+ *                      node to be passed to release()
+ */
+CLHNode* TimeoutCLH::acquire()
 {
-    thread_local bool mySense = false; 
+    return try_acquire_for(NO_TIMEOUT);
+}
 
-    if (false == mySense)   //flip sense here
+/*
+ * @brief       :   Releases the timeout CLH lock
+ *
+ * @params      :   CLHNode
+ *                      *nodeptr    :   node returned by acquire()
+ * 
+ * @returns     :   None
+ */
+void TimeoutCLH::release(CLHNode *nodeptr)
+{
+    CLHNode *expected = nodeptr;
+    if (tail.compare_exchange_strong(expected, NULL, SEQ_CST))
     {
-        mySense = true;
+        clh_node_put(nodeptr);      //nobody queued behind us
     }
     else
     {
-        mySense = false; 
+        nodeptr->pred.store(&available, SEQ_CST);   //successor recycles our node
     }
+}
+
+/*
+ * @brief       :   Frees nodes abandoned at the tail of the queue, the lock must
+ *                  be free and nobody may be waiting for it
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void TimeoutCLH::cleanup()
+{
+    CLHNode *nodeptr = tail.exchange(NULL, SEQ_CST);
+    while(nodeptr != NULL && nodeptr != &available)
+    {
+        CLHNode *pred = nodeptr->pred.load(SEQ_CST);
+        delete nodeptr;
+        nodeptr = pred;
+    }
+}
+
+/*
+ * @brief       :   Tries to acquire the timeout CLH lock until timeout, for
+ *                  std::TimedLockable
+ *
+ * @params      :   chrono::nanoseconds
+ *                      t       :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool TimeoutCLH::timed_lock(chrono::nanoseconds t)
+{
+    CLHNode *nodeptr = try_acquire_for(t);
+    if (nodeptr == NULL)
+    {
+        return false;
+    }
+    owner = nodeptr;
+    return true;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Implements a barrier using sense reversal barrier algorithm
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void Barrier::wait()
+{
+    //sense only flips once every thread has arrived, so every thread of this
+    //episode reads the same value. Taking it from the barrier instead of a
+    //thread_local lets pooled threads use many barriers and thread counts
+    bool mySense = !sense.load(SEQ_CST);
 
     int cnt_cpy = count.fetch_add(1, SEQ_CST);
     if (cnt_cpy == (numThreads-1))  //last to arrive
@@ -303,4 +783,772 @@ void Peterson::released_unlock(int threadId)
     desires[myTid].store(false, SEQ_CST);
 }
 /*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Tries to acquire the lock using peterson's algorithm using
+ *                  sequential consistency. If we would have to wait, the desire
+ *                  is withdrawn and the call fails
+ *
+ * @params      :   int
+ *                      threadId    :   Unique id of thread, 1 or 2
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool Peterson::sequential_trylock(int threadId)
+{
+    int myTid = (threadId == 1) ? 0 : 1;
+    int otherTid = 1 - myTid;
+
+    desires[myTid].store(true, SEQ_CST);
+    turn.store(otherTid, SEQ_CST);
+
+    if ((desires[otherTid].load(SEQ_CST)) && (turn.load(SEQ_CST)==otherTid))
+    {
+        desires[myTid].store(false, SEQ_CST);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * @brief       :   Tries to acquire the lock using peterson's algorithm using
+ *                  released consistency. If we would have to wait, the desire
+ *                  is withdrawn and the call fails
+ *
+ * @params      :   int
+ *                      threadId    :   Unique id of thread, 1 or 2
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool Peterson::released_trylock(int threadId)
+{
+    int myTid = (threadId == 1) ? 0 : 1;
+    int otherTid = 1 - myTid;
+
+    desires[myTid].store(true, memory_order_release);
+    turn.store(otherTid, SEQ_CST);
+
+    if ((desires[otherTid].load(SEQ_CST)) && (turn.load(SEQ_CST)==otherTid))
+    {
+        desires[myTid].store(false, SEQ_CST);
+        return false;
+    }
+    return true;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the lock using TTAS method with exponential backoff
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void BackoffLock::BO_lock()
+{
+    int delay = BACKOFF_MIN;
+    bool expected = false;
+    while(true)
+    {
+        while(bolock.load(SEQ_CST) == true);
+
+        if (bolock.compare_exchange_strong(expected, true, SEQ_CST))
+        {
+            return;
+        }
+        expected = false;
+
+        //someone else won, back off before trying again
+        for (int i = 0; i < delay; i++)
+        {
+            cpu_relax();
+        }
+        if (delay < BACKOFF_MAX)
+        {
+            delay *= 2;
+        }
+    }
+}
+
+/*
+ * @brief       :   Releases the backoff lock
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void BackoffLock::BO_unlock()
+{
+    bolock.store(false, SEQ_CST);
+}
+
+/*
+ * @brief       :   Tries to acquire the backoff lock, without waiting
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool BackoffLock::BO_trylock()
+{
+    bool expected = false;
+    return (bolock.load(SEQ_CST) == false) && 
+           bolock.compare_exchange_strong(expected, true, SEQ_CST);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the C-BO-MCS cohort lock. The local MCS lock of the
+ *                  node is acquired first, the global lock is acquired only if
+ *                  it was not passed to us by a thread of the same node
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ *                  Node
+ *                      *nodeptr    :   pointer to current thread's node
+ * 
+ * @returns     :   None
+ */
+void CohortBOMCS::acquire(int node, Node *nodeptr)
+{
+    MCSCohort *c = &cohorts[node];
+
+    c->local.acquire(nodeptr);
+
+    if (!c->ownsGlobal)
+    {
+        global.BO_lock();
+        c->ownsGlobal = true;
+        c->passCount = 0;
+    }
+}
+
+/*
+ * @brief       :   Releases the C-BO-MCS cohort lock. If another thread of the
+ *                  same node is waiting and the pass bound is not reached, the
+ *                  global lock is handed over with the local lock
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ *                  Node
+ *                      *nodeptr    :   pointer to current thread's node
+ * 
+ * @returns     :   None
+ */
+void CohortBOMCS::release(int node, Node *nodeptr)
+{
+    MCSCohort *c = &cohorts[node];
+
+    //someone queued behind us if our node is not the tail anymore
+    bool waiting = (nodeptr->next.load(SEQ_CST) != NULL) || (c->local.tail.load(SEQ_CST) != nodeptr);
+
+    if (waiting && c->passCount < passBound)
+    {
+        //keep the global lock within the node
+        c->passCount++;
+    }
+    else
+    {
+        c->ownsGlobal = false;
+        global.BO_unlock();
+    }
+    c->local.release(nodeptr);
+}
+
+/*
+ * @brief       :   Tries to acquire the C-BO-MCS cohort lock, without waiting
+ *                  for either the local or the global lock
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ *                  Node
+ *                      *nodeptr    :   pointer to current thread's node
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool CohortBOMCS::try_acquire(int node, Node *nodeptr)
+{
+    MCSCohort *c = &cohorts[node];
+
+    if (!c->local.try_acquire(nodeptr))
+    {
+        return false;
+    }
+    if (!c->ownsGlobal)
+    {
+        if (!global.BO_trylock())
+        {
+            c->local.release(nodeptr);
+            return false;
+        }
+        c->ownsGlobal = true;
+        c->passCount = 0;
+    }
+    return true;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the C-TKT-TKT cohort lock. The local ticket lock of
+ *                  the node is acquired first, the global lock is acquired only
+ *                  if it was not passed to us by a thread of the same node
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ * 
+ * @returns     :   None
+ */
+void CohortTktTkt::acquire(int node)
+{
+    TicketCohort *c = &cohorts[node];
+
+    c->local.Ticket_lock();
+
+    if (!c->ownsGlobal)
+    {
+        global.Ticket_lock();
+        c->ownsGlobal = true;
+        c->passCount = 0;
+    }
+}
+
+/*
+ * @brief       :   Releases the C-TKT-TKT cohort lock. If another thread of the
+ *                  same node holds a ticket and the pass bound is not reached,
+ *                  the global lock is handed over with the local lock
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ * 
+ * @returns     :   None
+ */
+void CohortTktTkt::release(int node)
+{
+    TicketCohort *c = &cohorts[node];
+
+    //tickets handed out beyond ours belong to waiting threads
+    bool waiting = (c->local.next_num.load(SEQ_CST) - c->local.now_serving.load(SEQ_CST)) > 1;
+
+    if (waiting && c->passCount < passBound)
+    {
+        //keep the global lock within the node
+        c->passCount++;
+    }
+    else
+    {
+        c->ownsGlobal = false;
+        global.Ticket_unlock();
+    }
+    c->local.Ticket_unlock();
+}
+
+/*
+ * @brief       :   Tries to acquire the C-TKT-TKT cohort lock, without waiting
+ *                  for either the local or the global lock
+ *
+ * @params      :   int
+ *                      node        :   node of the calling thread
+ * 
+ * @returns     :   bool
+ *                      true if the lock was acquired
+ */
+bool CohortTktTkt::try_acquire(int node)
+{
+    TicketCohort *c = &cohorts[node];
+
+    if (!c->local.Ticket_trylock())
+    {
+        return false;
+    }
+    if (!c->ownsGlobal)
+    {
+        if (!global.Ticket_trylock())
+        {
+            c->local.Ticket_unlock();
+            return false;
+        }
+        c->ownsGlobal = true;
+        c->passCount = 0;
+    }
+    return true;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the centralized RW lock for reading, waits while a
+ *                  writer holds the lock
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CentralRWLock::read_lock()
+{
+    int cnt = rwcount.load(SEQ_CST);
+    while(true)
+    {
+        if (cnt >= 0 && rwcount.compare_exchange_weak(cnt, cnt+1, SEQ_CST))
+        {
+            return;
+        }
+        if (cnt < 0)
+        {
+            cpu_relax();
+            cnt = rwcount.load(SEQ_CST);
+        }
+    }
+}
+
+/*
+ * @brief       :   Releases the centralized RW lock held for reading
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CentralRWLock::read_unlock()
+{
+    rwcount.fetch_sub(1, SEQ_CST);
+}
+
+/*
+ * @brief       :   Aqcuires the centralized RW lock for writing, waits until
+ *                  there are no readers and no writer
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CentralRWLock::write_lock()
+{
+    int expected = 0;
+    while(  
+            (rwcount.load(SEQ_CST) != 0) || 
+            !(rwcount.compare_exchange_strong(expected, -1, SEQ_CST))
+        )
+    {
+        expected = 0;
+        cpu_relax();
+    }
+}
+
+/*
+ * @brief       :   Releases the centralized RW lock held for writing
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CentralRWLock::write_unlock()
+{
+    rwcount.store(0, SEQ_CST);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the phase-fair RW lock for reading. A reader which
+ *                  arrives while a writer is present waits only for that one
+ *                  writer phase to end
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void PhaseFairRWLock::read_lock()
+{
+    unsigned int w = rin.fetch_add(PF_RINC, SEQ_CST) & PF_WBITS;
+    if (w != 0)
+    {
+        //wait until the writer phase we arrived in is over
+        while(w == (rin.load(SEQ_CST) & PF_WBITS));
+    }
+}
+
+/*
+ * @brief       :   Releases the phase-fair RW lock held for reading
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void PhaseFairRWLock::read_unlock()
+{
+    rout.fetch_add(PF_RINC, SEQ_CST);
+}
+
+/*
+ * @brief       :   Aqcuires the phase-fair RW lock for writing. Writers are
+ *                  ordered by ticket, then block new readers and wait for the
+ *                  readers already inside to leave
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void PhaseFairRWLock::write_lock()
+{
+    unsigned int ticket = win.fetch_add(1, SEQ_CST);
+    while(wout.load(SEQ_CST) != ticket);
+
+    unsigned int w = PF_PRES | (ticket & PF_PHID);
+    unsigned int rticket = rin.fetch_add(w, SEQ_CST);
+    while(rticket != rout.load(SEQ_CST));
+}
+
+/*
+ * @brief       :   Releases the phase-fair RW lock held for writing, letting
+ *                  the blocked readers in before the next writer
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void PhaseFairRWLock::write_unlock()
+{
+    rin.fetch_and(~PF_WBITS, SEQ_CST);
+    wout.fetch_add(1, SEQ_CST);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the distributed RW lock for reading. The reader only
+ *                  writes to its own slot, and backs off if a writer shows up
+ *
+ * @params      :   int
+ *                      slot    :   reader slot of the calling thread
+ * 
+ * @returns     :   None
+ */
+void DistRWLock::read_lock(int slot)
+{
+    while(true)
+    {
+        while(writer.load(SEQ_CST) == true);
+
+        slots[slot].active.store(true, SEQ_CST);
+
+        //a writer may have arrived between the check and our store
+        if (writer.load(SEQ_CST) == false)
+        {
+            return;
+        }
+        slots[slot].active.store(false, SEQ_CST);
+    }
+}
+
+/*
+ * @brief       :   Releases the distributed RW lock held for reading
+ *
+ * @params      :   int
+ *                      slot    :   reader slot of the calling thread
+ * 
+ * @returns     :   None
+ */
+void DistRWLock::read_unlock(int slot)
+{
+    slots[slot].active.store(false, SEQ_CST);
+}
+
+/*
+ * @brief       :   Aqcuires the distributed RW lock for writing, announces the
+ *                  writer and waits for every reader slot to drain
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void DistRWLock::write_lock()
+{
+    writerlock.TTAS_lock();
+    writer.store(true, SEQ_CST);
+    for (int i = 0; i < numSlots; i++)
+    {
+        while(slots[i].active.load(SEQ_CST) == true);
+    }
+}
+
+/*
+ * @brief       :   Releases the distributed RW lock held for writing
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void DistRWLock::write_unlock()
+{
+    writer.store(false, SEQ_CST);
+    writerlock.TTAS_unlock();
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Aqcuires the sequence lock for writing, writers are serialized
+ *                  by moving the sequence from even to odd with CAS
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SeqLock::write_lock()
+{
+    unsigned int s = seq.load(RELAXED);
+    while(true)
+    {
+        if (((s & 1) == 0) && seq.compare_exchange_weak(s, s+1, ACQUIRE))
+        {
+            break;
+        }
+        cpu_relax();
+        s = seq.load(RELAXED);
+    }
+    //updates must not become visible before the odd sequence
+    atomic_thread_fence(RELEASE_STORE);
+}
+
+/*
+ * @brief       :   Releases the sequence lock held for writing, making the
+ *                  sequence even again
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void SeqLock::write_unlock()
+{
+    seq.store(seq.load(RELAXED) + 1, RELEASE_STORE);
+}
+
+/*
+ * @brief       :   Starts a read, waits while a writer is active
+ *
+ * @params      :   None
+ * 
+ * @returns     :   unsigned int
+ *                      sequence to be passed to read_retry()
+ */
+unsigned int SeqLock::read_begin()
+{
+    unsigned int s = seq.load(ACQUIRE);
+    while(s & 1)
+    {
+        cpu_relax();
+        s = seq.load(ACQUIRE);
+    }
+    return s;
+}
+
+/*
+ * @brief       :   Finishes a read
+ *
+ * @params      :   unsigned int
+ *                      start   :   sequence returned by read_begin()
+ * 
+ * @returns     :   bool
+ *                      true if a writer was active and the read must be retried
+ */
+bool SeqLock::read_retry(unsigned int start)
+{
+    //reads of the data must complete before the sequence is checked again
+    atomic_thread_fence(ACQUIRE);
+    return seq.load(RELAXED) != start;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Sleeps while the 32-bit word at addr holds val
+ *
+ * @params      :   void
+ *                      *addr   :   address of the word
+ *                  unsigned int
+ *                      val     :   value the word is expected to hold
+ *                  const struct timespec
+ *                      *timeout:   relative timeout, NULL to wait forever
+ * 
+ * @returns     :   None, returns early on wakeup, signal, timeout or if the
+ *                  word does not hold val
+ */
+static void futex_wait(void *addr, unsigned int val, const struct timespec *timeout)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, timeout, NULL, 0);
+}
+
+/*
+ * @brief       :   Wakes threads sleeping on the 32-bit word at addr
+ *
+ * @params      :   void
+ *                      *addr   :   address of the word
+ *                  int
+ *                      count   :   maximum number of threads to wake
+ * 
+ * @returns     :   None
+ */
+static void futex_wake(void *addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Waits until the condition variable is notified after start
+ *                  was read, spins first and then sleeps
+ *
+ * @params      :   unsigned int
+ *                      start   :   value of seq read while the lock was held
+ * 
+ * @returns     :   None
+ */
+void CondVar::wait_seq(unsigned int start)
+{
+    for (int i = 0; i < SPIN_BEFORE_BLOCK; i++)
+    {
+        if (seq.load(ACQUIRE) != start)
+        {
+            return;
+        }
+        cpu_relax();
+    }
+
+    //notifiers only make the syscall if somebody may be asleep
+    waiters.fetch_add(1, SEQ_CST);
+    while (seq.load(SEQ_CST) == start)
+    {
+        futex_wait(&seq, start, NULL);
+    }
+    waiters.fetch_sub(1, SEQ_CST);
+}
+
+/*
+ * @brief       :   Waits until the condition variable is notified after start
+ *                  was read or until timeout, spins first and then sleeps
+ *
+ * @params      :   unsigned int
+ *                      start   :   value of seq read while the lock was held
+ *                  chrono::nanoseconds
+ *                      timeout :   maximum time to wait
+ * 
+ * @returns     :   bool
+ *                      false if the timeout expired without a notification
+ */
+bool CondVar::wait_seq_for(unsigned int start, chrono::nanoseconds timeout)
+{
+    auto deadline = chrono::steady_clock::now() + timeout;
+    for (int i = 0; i < SPIN_BEFORE_BLOCK; i++)
+    {
+        if (seq.load(ACQUIRE) != start)
+        {
+            return true;
+        }
+        cpu_relax();
+    }
+
+    bool notified = true;
+    waiters.fetch_add(1, SEQ_CST);
+    while (seq.load(SEQ_CST) == start)
+    {
+        chrono::nanoseconds left = deadline - chrono::steady_clock::now();
+        if (left.count() <= 0)
+        {
+            notified = false;
+            break;
+        }
+        struct timespec ts;
+        ts.tv_sec = left.count() / 1000000000;
+        ts.tv_nsec = left.count() % 1000000000;
+        futex_wait(&seq, start, &ts);
+    }
+    waiters.fetch_sub(1, SEQ_CST);
+    return notified;
+}
+
+/*
+ * @brief       :   Wakes one thread waiting on the condition variable
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CondVar::notify_one()
+{
+    seq.fetch_add(1, SEQ_CST);
+    if (waiters.load(SEQ_CST) > 0)
+    {
+        futex_wake(&seq, 1);
+    }
+}
+
+/*
+ * @brief       :   Wakes all threads waiting on the condition variable
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CondVar::notify_all()
+{
+    seq.fetch_add(1, SEQ_CST);
+    if (waiters.load(SEQ_CST) > 0)
+    {
+        futex_wake(&seq, INT_MAX);
+    }
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Takes a permit of the semaphore if one is available
+ *
+ * @params      :   None
+ * 
+ * @returns     :   bool
+ *                      true if a permit was taken
+ */
+bool Semaphore::try_wait()
+{
+    int c = count.load(SEQ_CST);
+    while (c > 0)
+    {
+        if (count.compare_exchange_weak(c, c-1, SEQ_CST))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * @brief       :   Takes a permit of the semaphore, spins first and then sleeps
+ *                  until a permit is posted
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void Semaphore::wait()
+{
+    for (int i = 0; i < SPIN_BEFORE_BLOCK; i++)
+    {
+        if (try_wait())
+        {
+            return;
+        }
+        cpu_relax();
+    }
+
+    //post() only makes the syscall if somebody may be asleep
+    waiters.fetch_add(1, SEQ_CST);
+    while (!try_wait())
+    {
+        futex_wait(&count, 0, NULL);
+    }
+    waiters.fetch_sub(1, SEQ_CST);
+}
+
+/*
+ * @brief       :   Returns a permit to the semaphore and wakes one sleeper
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void Semaphore::post()
+{
+    count.fetch_add(1, SEQ_CST);
+    if (waiters.load(SEQ_CST) > 0)
+    {
+        futex_wake(&count, 1);
+    }
+}
+/*---------------------------------------------------------------------------------*/
 /*EOF*/
\ No newline at end of file
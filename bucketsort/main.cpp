@@ -16,10 +16,20 @@
 #include <cstdbool> //for boolean values
 #include <string>   //for strings
 #include <cstdlib>  //for exit()
+#include <limits>   //for digits needed to print floating point keys
+#include <span>
 
 #include "bucketsort.h"
 #include "locks.h"
 #include "time.h"
+#include "perf.h"
+#include "affinity.h"
+#include "threadpool.h"
+#include "classify.h"
+#include "memplace.h"
+#include "extsort.h"
+#include "phasetimer.h"
+#include "locktrace.h"
 
 /*PRIVATE DEFINES*/
 #define DEFAULT_NUMTHREADS      (4)
@@ -33,7 +43,27 @@ enum
 {
     usr_name = 0,
     barriers, 
-    locks
+    locks,
+    perf,
+    pin,
+    cpus,
+    nodes,
+    cohort_bound,
+    trylock,
+    batch,
+    engines,
+    no_simd,
+    stage_size,
+    thp,
+    mem_policy,
+    mem_limit,
+    key_type,
+    payload_size,
+    stable,
+    repeat,
+    warmup,
+    phases,
+    lock_trace
 };
 /*--------------------------------------------------------------------*/
 /*GLOBAL VARIABLES*/
@@ -43,29 +73,66 @@ struct option long_cmd_options[] =
 {
     {"name", no_argument, 0, usr_name},
     {"bar", required_argument, 0, barriers},
-    {"lock", required_argument, 0, locks}
+    {"lock", required_argument, 0, locks},
+    {"perf", no_argument, 0, perf},
+    {"pin", required_argument, 0, pin},
+    {"cpus", required_argument, 0, cpus},
+    {"nodes", required_argument, 0, nodes},
+    {"cohort-bound", required_argument, 0, cohort_bound},
+    {"trylock", no_argument, 0, trylock},
+    {"batch", required_argument, 0, batch},
+    {"engine", required_argument, 0, engines},
+    {"no-simd", no_argument, 0, no_simd},
+    {"stage-size", required_argument, 0, stage_size},
+    {"thp", no_argument, 0, thp},
+    {"mem-policy", required_argument, 0, mem_policy},
+    {"mem-limit", required_argument, 0, mem_limit},
+    {"key-type", required_argument, 0, key_type},
+    {"payload", required_argument, 0, payload_size},
+    {"stable", no_argument, 0, stable},
+    {"repeat", required_argument, 0, repeat},
+    {"warmup", required_argument, 0, warmup},
+    {"phases", no_argument, 0, phases},
+    {"lock-trace", required_argument, 0, lock_trace},
+    {0, 0, 0, 0}
 };
 
 /*short commands*/
 const char *short_cmd_options = "o:t:";
 
+/*settings of every sort, filled from the command line*/
+static sorterConfig_t sortConfig;
+
+/*sorter used for every list, created by the first sort*/
+static Sorter *sorter = NULL;
+
+/*measured sorts of every list, unmeasured sorts before them, and the elapsed
+  time of every measured sort of the last list*/
+static int numRuns = 1;
+static int numWarmup = 0;
+static vector<unsigned long long> runTimes;
+
+/*Chrome trace written by --lock-trace*/
+static string lockTraceFile;
+
 /*--------------------------------------------------------------------*/
 /*
  * @brief       :   Reads all numbers from a file
  * 
  * @parameters  :   string
  *                      inputFile   :   path to the file   
- *                  vector <int>&
+ *                  vector <T>&
  *                      list        :   array in which numbers are to be stored
  *
  * @returns     :   none, exits with EXIT_FAILURE if file opening fails
  */
-void readFromFile (string inputFile, vector <int>& list)
+template <typename T>
+void readFromFile (string inputFile, vector <T>& list)
 {
     //create instance of ifstream to read file
     ifstream fin;
     //local variable to store value read from file
-    int val; 
+    T val; 
 
     //open the file and check if file opening succeeded 
     fin.open(inputFile);
@@ -99,12 +166,13 @@ void readFromFile (string inputFile, vector <int>& list)
  * 
  * @parameters  :   string
  *                      outputFile   :   path to the file   
- *                  vector <int>&
+ *                  vector <T>&
  *                      list         :   sorted list to be written
  *
  * @returns     :   none, exits with EXIT_FAILURE if file opening fails
  */
-void writeToFile (string outputFile, vector <int>& list)
+template <typename T>
+void writeToFile (string outputFile, vector <T>& list)
 {
     //create instance of ofstream to write to file
     ofstream fout;
@@ -116,8 +184,13 @@ void writeToFile (string outputFile, vector <int>& list)
         cout << "Failed to open file, exiting ..." << endl;
         exit(EXIT_FAILURE);
     }
+    //floating point keys are printed with enough digits to read them back exactly
+    if (is_floating_point<T>::value)
+    {
+        fout.precision(numeric_limits<T>::max_digits10);
+    }
     //create an iterator to go through all elements in the vector list
-    vector<int>::iterator itr = list.begin();
+    typename vector<T>::iterator itr = list.begin();
     //iterate through all elements 
     for(itr = list.begin(); itr != list.end(); itr++)
     {
@@ -134,15 +207,16 @@ void writeToFile (string outputFile, vector <int>& list)
  * @parameters  :   string
  *                      locktype       :  type of locking algorithm to be used
  *                      barriertype    :  type of barrier to be used 
- *                  vector <int>&
- *                      num_list     :   list of numbers to be sorted
+ *                  vector <T>&
+ *                      num_list     :   list of numbers or records to be sorted
  *                  int         
  *                      list_size    :   number of elements in the list
  *                      num_threads  :   number of threads to be used in the application
  *
  * @returns     :   none
  */
-void sort_list(string lockingType, string barrierType, vector<int>& num_list, int list_size, int num_threads)
+template <typename T>
+void sort_list(string lockingType, string barrierType, vector<T>& num_list, int list_size, int num_threads)
 {
     //local variable for number of threads
     int numThreads = 0;
@@ -202,6 +276,18 @@ void sort_list(string lockingType, string barrierType, vector<int>& num_list, in
     {
         alg = PETERSON_REL_algorithm;
     }
+    else if (lockingType == "cbomcs")
+    {
+        alg = COHORT_BO_MCS_algorithm;
+    }
+    else if (lockingType == "ctkttkt")
+    {
+        alg = COHORT_TKT_TKT_algorithm;
+    }
+    else if (lockingType == "clh")
+    {
+        alg = TIMEOUT_CLH_algorithm;
+    }
     else    /*default algorithm is pthread*/
     {
         alg = PTHREAD_algorithm;
@@ -219,8 +305,357 @@ void sort_list(string lockingType, string barrierType, vector<int>& num_list, in
         bar = PTHREAD_type;
     }
     /*-------------------------------------------------------------------------*/
-    //now, send everything to bucketsort
-    bucketsort(alg, bar, num_list, list_size, numThreads);
+    //now, send everything to the sorter, other key types and records go to the generic engine
+    sortConfig.lock = alg;
+    sortConfig.bar = bar;
+    sortConfig.numThreads = numThreads;
+    if (sorter == NULL)
+    {
+        sorter = sorter_init(sortConfig);
+    }
+    sorter->config = sortConfig;
+    sorter->sort(span<T>(num_list));
+
+    //report the timed region of this sort
+    startTime = sorter->startTime;
+    endTime = sorter->endTime;
+}
+
+/*
+ * @brief       :   sorts the input list numWarmup + numRuns times. Every sort
+ *                  after the first starts from a fresh copy of the unsorted
+ *                  input, the elapsed time of the measured sorts is kept in
+ *                  runTimes. Phase times of the warmup sorts are dropped
+ * 
+ * @parameters  :   same as sort_list()
+ *
+ * @returns     :   none
+ */
+template <typename T>
+void sort_repeated(string lockingType, string barrierType, vector<T>& num_list, int list_size, int num_threads)
+{
+    //the sort is in place, keep the input only if it is sorted again
+    vector<T> input;
+    if (numWarmup + numRuns > 1)
+    {
+        input = num_list;
+    }
+
+    runTimes.clear();
+    for (int r = 0; r < numWarmup + numRuns; r++)
+    {
+        if (r > 0)
+        {
+            copy(input.begin(), input.end(), num_list.begin());
+        }
+        if ((r == numWarmup) && (numWarmup > 0))
+        {
+            phase_restart();
+            locktrace_reset();
+        }
+        sort_list(lockingType, barrierType, num_list, list_size, num_threads);
+        if (r >= numWarmup)
+        {
+            runTimes.push_back(elapsed_ns(&startTime, &endTime));
+        }
+    }
+}
+
+/*
+ * @brief       :   prints the elapsed time of the last sort, or statistics
+ *                  over every measured sort with --repeat
+ * 
+ * @parameters  :   none
+ *
+ * @returns     :   none
+ */
+static void printRunTimes()
+{
+    if (numRuns > 1)
+    {
+        printTimeStats(runTimes, numWarmup);
+    }
+    else
+    {
+        printTimeDifference();
+    }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   sorts a file of keys as records with a payload. The payload
+ *                  holds the line number of the key, and is checked after the
+ *                  sort to make sure every payload moved with its key. With
+ *                  --stable, equal keys must also be in input order
+ * 
+ * @parameters  :   string
+ *                      inputFile      :  file with one key per line
+ *                      outputFile     :  file the sorted keys are written to
+ *                      locktype       :  type of locking algorithm to be used
+ *                      barriertype    :  type of barrier to be used 
+ *                  int         
+ *                      num_threads    :  number of threads to be used in the application
+ *
+ * @returns     :   none, exits with EXIT_FAILURE if a payload does not match its key
+ *                  or equal keys are out of order
+ */
+template <typename K, size_t P>
+static void sort_records(string inputFile, string outputFile, string lockingType, string barrierType, int num_threads)
+{
+    vector <K> keys;
+    uint64_t tick = phase_clock();
+    readFromFile(inputFile, keys);
+    phase_add(1, PHASE_PARSE, tick);
+
+    vector <record<K, P>> records(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        uint64_t line = i;
+        records[i].key = keys[i];
+        memset(records[i].payload, 0, P);
+        memcpy(records[i].payload, &line, sizeof(line));
+    }
+
+    sort_repeated(lockingType, barrierType, records, records.size(), num_threads);
+
+    vector <K> sorted(records.size());
+    uint64_t prevLine = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        uint64_t line;
+        memcpy(&line, records[i].payload, sizeof(line));
+        if (line >= keys.size() || keys[line] != records[i].key)
+        {
+            cout << "Payload of record " << i << " does not match its key, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        if (sortConfig.stable && i > 0 && records[i].key == records[i-1].key && line < prevLine)
+        {
+            cout << "Record " << i << " is out of input order among equal keys, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        prevLine = line;
+        sorted[i] = records[i].key;
+    }
+    tick = phase_clock();
+    writeToFile(outputFile, sorted);
+    phase_add(1, PHASE_WRITE, tick);
+}
+
+/*
+ * @brief       :   sorts a file of keys of the given type
+ * 
+ * @parameters  :   string
+ *                      inputFile      :  file with one key per line
+ *                      outputFile     :  file the sorted keys are written to
+ *                      locktype       :  type of locking algorithm to be used
+ *                      barriertype    :  type of barrier to be used 
+ *                  int         
+ *                      num_threads    :  number of threads to be used in the application
+ *
+ * @returns     :   none
+ */
+template <typename T>
+static void sort_keys(string inputFile, string outputFile, string lockingType, string barrierType, int num_threads)
+{
+    vector <T> keys;
+    uint64_t tick = phase_clock();
+    readFromFile(inputFile, keys);
+    tick = phase_add(1, PHASE_PARSE, tick);
+    sort_repeated(lockingType, barrierType, keys, keys.size(), num_threads);
+    tick = phase_clock();
+    writeToFile(outputFile, keys);
+    phase_add(1, PHASE_WRITE, tick);
+}
+
+/*
+ * @brief       :   sorts a file with the key type and payload size given by
+ *                  --key-type and --payload
+ * 
+ * @parameters  :   string
+ *                      keyType        :  i32, u32, i64, u64, f32 or f64
+ *                  int
+ *                      payload        :  payload bytes of every record, 0 sorts plain keys
+ *                  string
+ *                      inputFile      :  file with one key per line
+ *                      outputFile     :  file the sorted keys are written to
+ *                      locktype       :  type of locking algorithm to be used
+ *                      barriertype    :  type of barrier to be used 
+ *                  int         
+ *                      num_threads    :  number of threads to be used in the application
+ *
+ * @returns     :   none, exits with EXIT_FAILURE for an unsupported combination
+ */
+static void sort_typed(string keyType, int payload, string inputFile, string outputFile, string lockingType, string barrierType, int num_threads)
+{
+    if (payload > 0)
+    {
+        //records are built for 64-bit keys only
+        bool isSigned = (keyType == "i64" || keyType.empty());
+        if (!isSigned && keyType != "u64")
+        {
+            cout << "Records need a 64-bit key type, exiting ..." << endl;
+            exit(EXIT_FAILURE);
+        }
+        switch (payload)
+        {
+            case 8:     isSigned ? sort_records<int64_t, 8>(inputFile, outputFile, lockingType, barrierType, num_threads)
+                                 : sort_records<uint64_t, 8>(inputFile, outputFile, lockingType, barrierType, num_threads); break;
+            case 16:    isSigned ? sort_records<int64_t, 16>(inputFile, outputFile, lockingType, barrierType, num_threads)
+                                 : sort_records<uint64_t, 16>(inputFile, outputFile, lockingType, barrierType, num_threads); break;
+            case 24:    isSigned ? sort_records<int64_t, 24>(inputFile, outputFile, lockingType, barrierType, num_threads)
+                                 : sort_records<uint64_t, 24>(inputFile, outputFile, lockingType, barrierType, num_threads); break;
+            case 32:    isSigned ? sort_records<int64_t, 32>(inputFile, outputFile, lockingType, barrierType, num_threads)
+                                 : sort_records<uint64_t, 32>(inputFile, outputFile, lockingType, barrierType, num_threads); break;
+            default:
+                cout << "Payload must be 8, 16, 24 or 32 bytes, exiting ..." << endl;
+                exit(EXIT_FAILURE);
+        }
+    }
+    else if (keyType == "i32")
+    {
+        sort_keys<int32_t>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else if (keyType == "u32")
+    {
+        sort_keys<uint32_t>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else if (keyType == "i64")
+    {
+        sort_keys<int64_t>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else if (keyType == "u64")
+    {
+        sort_keys<uint64_t>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else if (keyType == "f32")
+    {
+        sort_keys<float>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else if (keyType == "f64")
+    {
+        sort_keys<double>(inputFile, outputFile, lockingType, barrierType, num_threads);
+    }
+    else
+    {
+        cout << "Unknown key type, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   sorts every file of a batch back-to-back, reusing the
+ *                  same thread pool
+ * 
+ * @parameters  :   string
+ *                      batchFile      :  file with one "input output" pair per line
+ *                      locktype       :  type of locking algorithm to be used
+ *                      barriertype    :  type of barrier to be used 
+ *                  int         
+ *                      num_threads    :  number of threads to be used in the application
+ *
+ * @returns     :   none, exits with EXIT_FAILURE if file opening fails
+ */
+static void sort_batch(string batchFile, string lockingType, string barrierType, int num_threads)
+{
+    //create instance of ifstream to read the list of files
+    ifstream fin;
+    string inputFile, outputFile;
+
+    fin.open(batchFile);
+    if(!fin)
+    {
+        //if file opening failed, exit
+        cout << "Failed to open file, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    //sort each pair of files, the pool is created by the first sort only
+    while(fin >> inputFile >> outputFile)
+    {
+        vector <int> num_list;
+        phase_reset();
+        locktrace_reset();
+        uint64_t tick = phase_clock();
+        readFromFile(inputFile, num_list);
+        phase_add(1, PHASE_PARSE, tick);
+        sort_repeated(lockingType, barrierType, num_list, num_list.size(), num_threads);
+        tick = phase_clock();
+        writeToFile(outputFile, num_list);
+        phase_add(1, PHASE_WRITE, tick);
+
+        cout << inputFile << endl;
+        printRunTimes();
+        printPerfCounters();
+        printPhaseTimes(numRuns);
+        printLockTrace(lockTraceFile);
+    }
+
+    //close file
+    fin.close();
+}
+
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   converts a size with an optional K, M or G suffix to bytes
+ * 
+ * @parameters  :   string
+ *                      size    :   size, e.g. 512M
+ *
+ * @returns     :   size_t
+ *                      size in bytes, 0 if the size is malformed
+ */
+static size_t parse_size(string size)
+{
+    char *end = NULL;
+    unsigned long long val = strtoull(size.c_str(), &end, 10);
+    switch (*end)
+    {
+        case 'k': case 'K':     val <<= 10; break;
+        case 'm': case 'M':     val <<= 20; break;
+        case 'g': case 'G':     val <<= 30; break;
+        default:                break;
+    }
+    return (size_t)val;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   determines how threads are to be pinned to cpus
+ * 
+ * @parameters  :   string
+ *                      pinType     :   compact, scatter or none
+ *                      cpuList     :   explicit list of cpus, e.g. 0,2,4-7
+ *
+ * @returns     :   none, exits with EXIT_FAILURE if the cpu list is malformed
+ */
+static void determine_pinning(string pinType, string cpuList)
+{
+    pin_policy_t policy = PIN_NONE;
+
+    if (!cpuList.empty())
+    {
+        policy = PIN_LIST;
+    }
+    else if (pinType == "compact")
+    {
+        policy = PIN_COMPACT;
+    }
+    else if (pinType == "scatter")
+    {
+        policy = PIN_SCATTER;
+    }
+    else    /*threads are not pinned by default*/
+    {
+        policy = PIN_NONE;
+    }
+
+    if (!pin_init(policy, cpuList))
+    {
+        cout << "Invalid cpu list, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
 }
 
 /*--------------------------------------------------------------------*/
@@ -249,11 +684,24 @@ int main(int argc, char* argv[])
 
     string lockType, barrierType; 
 
+    //thread placement
+    string pinType, cpuList;
+
     //number of threads
     int num_threads=0;
 
     bool nameflag = false;
 
+    //list of files to be sorted in batch mode, empty if not used
+    string batchFile;
+
+    //memory budget of the external sort in bytes, 0 sorts in memory
+    size_t memLimit = 0;
+
+    //key type and payload bytes of the generic engine, empty and 0 sort ints
+    string keyType;
+    int payload = 0;
+
     //get command line arguments that start with '-' or '--'
     while((opt = getopt_long(argc, argv, short_cmd_options, long_cmd_options, NULL)) != -1)
     {
@@ -285,6 +733,129 @@ int main(int argc, char* argv[])
                 barrierType = optarg; 
             break;
 
+            case perf:
+                //collect hardware counters around the timed region
+                perfFlag = true;
+            break;
+
+            case pin:
+                //thread placement policy
+                pinType = optarg;
+            break;
+
+            case cpus:
+                //explicit list of cpus, overrides --pin
+                cpuList = optarg;
+            break;
+
+            case nodes:
+                //split threads into groups to simulate numa nodes for cohort locks
+                simulatedNodes = atoi(optarg);
+            break;
+
+            case cohort_bound:
+                //local handoffs of cohort locks before the global lock is released
+                cohortPassBound = atoi(optarg);
+            break;
+
+            case trylock:
+                //defer elements to a thread-local buffer while the lock is held
+                sortConfig.tryLock = true;
+            break;
+
+            case batch:
+                //sort every file listed in this file with the same threads
+                batchFile = optarg;
+            break;
+
+            case engines:
+                //sorting engine, lock-based bucket sort by default
+                if (string(optarg) == "radix")
+                {
+                    sortConfig.engine = RADIX_engine;
+                }
+                else if (string(optarg) == "mergesort")
+                {
+                    sortConfig.engine = MERGE_engine;
+                }
+                else
+                {
+                    sortConfig.engine = BUCKET_engine;
+                }
+            break;
+
+            case no_simd:
+                //classify elements with scalar code even if the cpu has AVX2
+                simdFlag = false;
+            break;
+
+            case stage_size:
+                //elements staged per bucket before they are inserted under one lock
+                sortConfig.stageSize = max(0, atoi(optarg));
+            break;
+
+            case thp:
+                //back the arrays being sorted with transparent huge pages
+                thpFlag = true;
+            break;
+
+            case mem_policy:
+                //who touches the arrays being sorted first, or interleave them over nodes
+                if (string(optarg) == "first-touch")
+                {
+                    memPolicy = MEM_FIRST_TOUCH;
+                }
+                else if (string(optarg) == "interleave")
+                {
+                    memPolicy = MEM_INTERLEAVE;
+                }
+                else
+                {
+                    memPolicy = MEM_DEFAULT;
+                }
+            break;
+
+            case mem_limit:
+                //sort out of core, in chunks that fit in this many bytes
+                memLimit = parse_size(optarg);
+            break;
+
+            case key_type:
+                //sort keys of another type with the generic engine
+                keyType = optarg;
+            break;
+
+            case payload_size:
+                //sort records with a payload of this many bytes
+                payload = atoi(optarg);
+            break;
+
+            case stable:
+                //equal keys keep their input order
+                sortConfig.stable = true;
+            break;
+
+            case repeat:
+                //sort every list this many times and report statistics
+                numRuns = max(1, atoi(optarg));
+            break;
+
+            case warmup:
+                //sorts before the measured ones, not reported
+                numWarmup = max(0, atoi(optarg));
+            break;
+
+            case phases:
+                //time the phases of every thread
+                phaseFlag = true;
+            break;
+
+            case lock_trace:
+                //trace every acquisition of the bucket lock, timeline goes to a JSON file
+                lockTraceFlag = true;
+                lockTraceFile = optarg;
+            break;
+
             case 't':
                 num_threads = atoi(optarg);
             break;
@@ -299,26 +870,99 @@ int main(int argc, char* argv[])
 
     }
 
-    if (!nameflag)
+    //room for the parse and write phases of the main thread, one lock trace for every sort
+    phase_init(1);
+    locktrace_reset();
+
+    if (!nameflag && !batchFile.empty())
+    {
+        determine_pinning(pinType, cpuList);
+        sort_batch(batchFile, lockType, barrierType, num_threads);
+    }
+    else if (!nameflag && (!keyType.empty() || payload > 0))
+    {
+        determine_pinning(pinType, cpuList);
+
+        //read, sort and write keys or records of the requested type
+        sort_typed(keyType, payload, ip_filename, op_filename, lockType, barrierType, num_threads);
+
+        printRunTimes();
+        printPerfCounters();
+        printPhaseTimes(numRuns);
+        printLockTrace(lockTraceFile);
+    }
+    else if (!nameflag && memLimit > 0)
+    {
+        determine_pinning(pinType, cpuList);
+
+        //the runs are merged on the pool of the sorter which sorts the chunks
+        if (sorter == NULL)
+        {
+            sorter = sorter_init(sortConfig);
+        }
+
+        //every chunk is sorted in memory by the selected engine, every run reads the input again
+        for (int r = 0; r < numWarmup + numRuns; r++)
+        {
+            if ((r == numWarmup) && (numWarmup > 0))
+            {
+                phase_restart();
+                locktrace_reset();
+            }
+            struct timespec extStart;
+            getTime(&extStart);
+            external_sort(sorter, ip_filename, op_filename, memLimit, (num_threads > 0) ? num_threads : DEFAULT_NUMTHREADS,
+                          [&](vector<int>& chunk)
+                          {
+                              sort_list(lockType, barrierType, chunk, chunk.size(), num_threads);
+                          });
+
+            //report the whole external sort, not the last chunk
+            startTime = extStart;
+            getTime(&endTime);
+            if (r >= numWarmup)
+            {
+                runTimes.push_back(elapsed_ns(&startTime, &endTime));
+            }
+        }
+
+        printRunTimes();
+        printPerfCounters();
+        printPhaseTimes(numRuns);
+        printLockTrace(lockTraceFile);
+    }
+    else if (!nameflag)
     {
+        determine_pinning(pinType, cpuList);
+
         //declare a vector list to hold input numbers
         vector <int> num_list;
 
         //get numbers from the input file
+        uint64_t tick = phase_clock();
         readFromFile(ip_filename, num_list);
+        phase_add(1, PHASE_PARSE, tick);
 
         //determine list size
         int list_size = num_list.size();
 
         //sort the list based on sorting method selected
-        sort_list(lockType, barrierType, num_list, list_size, num_threads);
+        sort_repeated(lockType, barrierType, num_list, list_size, num_threads);
 
         //write sorted list to file 
+        tick = phase_clock();
         writeToFile(op_filename, num_list);
+        phase_add(1, PHASE_WRITE, tick);
 
-        printTimeDifference();
+        printRunTimes();
+        printPerfCounters();
+        printPhaseTimes(numRuns);
+        printLockTrace(lockTraceFile);
     }
 
+    //stop the workers of the sorter
+    sorter_delete(sorter);
+
     return 0;
 }
 /*--------------------------------------------------------------------*/
@@ -0,0 +1,168 @@
+/*
+ *  @fileName       :   memplace.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <cstdint>
+#include <new>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "memplace.h"
+#include "affinity.h"
+
+using namespace std;
+
+/*Global variables*/
+mem_policy_t memPolicy = MEM_DEFAULT;   /*placement of the arrays being sorted*/
+bool thpFlag = false;                   /*back large arrays with transparent huge pages*/
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   returns true if arrays have to be allocated by mem_alloc()
+ *                  instead of being used where the main thread put them
+ *
+ * @params      :   None
+ *
+ * @returns     :   bool
+ *                      true if --mem-policy or --thp was given
+ */
+bool mem_placed()
+{
+    return (memPolicy != MEM_DEFAULT) || thpFlag;
+}
+
+/*
+ * @brief       :   applies --thp and --mem-policy=interleave to the whole pages
+ *                  inside a region. Pages which are already touched keep
+ *                  their node
+ *
+ * @params      :   void
+ *                      *p      :   start of the region
+ *                  size_t
+ *                      bytes   :   size of the region
+ *
+ * @returns     :   None
+ */
+void mem_advise(void *p, size_t bytes)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)p + page - 1) & ~(uintptr_t)(page - 1);
+    uintptr_t end = ((uintptr_t)p + bytes) & ~(uintptr_t)(page - 1);
+    if (end <= start)
+    {
+        return;
+    }
+
+    if (thpFlag)
+    {
+        //a hint only, kernels without THP ignore it
+        madvise((void*)start, end - start, MADV_HUGEPAGE);
+    }
+
+    if (memPolicy == MEM_INTERLEAVE)
+    {
+        int nodes = topology_num_nodes();
+        unsigned long mask = (nodes >= 64) ? ~0UL : ((1UL << nodes) - 1);
+        //fails harmlessly on kernels without numa support
+        syscall(SYS_mbind, (void*)start, end - start, MPOL_INTERLEAVE, &mask, sizeof(mask) * 8, 0);
+    }
+}
+
+/*
+ * @brief       :   maps untouched memory aligned to a huge page, so that it can
+ *                  be backed by huge pages and placed by first touch
+ *
+ * @params      :   size_t
+ *                      bytes   :   size of the request
+ *
+ * @returns     :   void*
+ *                      memory to be freed with mem_free()
+ */
+void* mem_alloc(size_t bytes)
+{
+    size_t len = (bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    if (len == 0)
+    {
+        len = HUGE_PAGE_SIZE;
+    }
+
+    //map one huge page more and trim both ends to get an aligned region
+    char *raw = (char*)mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        throw bad_alloc();
+    }
+    char *aligned = (char*)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > raw)
+    {
+        munmap(raw, aligned - raw);
+    }
+    char *tail = aligned + len;
+    if (tail < raw + len + HUGE_PAGE_SIZE)
+    {
+        munmap(tail, (raw + len + HUGE_PAGE_SIZE) - tail);
+    }
+
+    mem_advise(aligned, len);
+    return aligned;
+}
+
+/*
+ * @brief       :   unmaps memory returned by mem_alloc()
+ *
+ * @params      :   void
+ *                      *p      :   memory returned by mem_alloc()
+ *                  size_t
+ *                      bytes   :   size passed to mem_alloc()
+ *
+ * @returns     :   None
+ */
+void mem_free(void *p, size_t bytes)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    size_t len = (bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    if (len == 0)
+    {
+        len = HUGE_PAGE_SIZE;
+    }
+    munmap(p, len);
+}
+
+/*
+ * @brief       :   writes one byte of every page, so the calling thread takes
+ *                  the page faults and, with first touch, pages land on its node.
+ *                  Contents of the region are lost
+ *
+ * @params      :   void
+ *                      *p      :   start of the region
+ *                  size_t
+ *                      bytes   :   size of the region
+ *
+ * @returns     :   None
+ */
+void mem_touch(void *p, size_t bytes)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    volatile char *c = (volatile char*)p;
+    for (size_t off = 0; off < bytes; off += page)
+    {
+        c[off] = 0;
+    }
+    if (bytes > 0)
+    {
+        c[bytes-1] = 0;     //last page, if the region does not start on a page
+    }
+}
+
+/*EOF*/
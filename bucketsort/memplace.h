@@ -0,0 +1,40 @@
+/*
+ *  @fileName       :   memplace.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _MEMPLACE_H_
+#define _MEMPLACE_H_
+
+#include <iostream>
+#include <cstdbool>
+
+/*GLOBAL DEFINES*/
+#define HUGE_PAGE_SIZE  (2 << 20)   /*size of a transparent huge page on x86-64*/
+
+/*ENUMERATED LIST OF ALL AVAILABLE MEMORY PLACEMENT POLICIES*/
+typedef enum mem_policies
+{
+    MEM_DEFAULT = 0,    /*arrays are allocated and touched by the main thread*/
+    MEM_FIRST_TOUCH,    /*every worker touches the slice it processes first*/
+    MEM_INTERLEAVE      /*pages are spread round-robin over all numa nodes*/
+}mem_policy_t;
+
+extern mem_policy_t memPolicy;  /*set by --mem-policy*/
+extern bool thpFlag;            /*set by --thp*/
+
+bool mem_placed();
+
+void* mem_alloc(size_t bytes);
+
+void mem_free(void *p, size_t bytes);
+
+void mem_advise(void *p, size_t bytes);
+
+void mem_touch(void *p, size_t bytes);
+
+#endif /*_MEMPLACE_H_*/
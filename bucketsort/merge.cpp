@@ -0,0 +1,160 @@
+/*
+ *  @fileName       :   merge.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <algorithm>
+
+#include "merge.h"
+
+using namespace std;
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   decides a match, exhausted sources lose against everything
+ *
+ * @params      :   int
+ *                      a, b    :   sources playing the match
+ *
+ * @returns     :   bool
+ *                      true if a wins against b
+ */
+bool LoserTree::less(int a, int b)
+{
+    if (done[a])
+    {
+        return false;
+    }
+    if (done[b])
+    {
+        return true;
+    }
+    return key[a] < key[b];
+}
+
+/*
+ * @brief       :   plays every match below a node, storing the losers
+ *
+ * @params      :   int
+ *                      n       :   node, leaves are k..2k-1
+ *
+ * @returns     :   int
+ *                      winner of the subtree
+ */
+int LoserTree::build(int n)
+{
+    if (n >= k)
+    {
+        return n - k;
+    }
+    int left = build(2*n);
+    int right = build(2*n + 1);
+    if (less(right, left))
+    {
+        node[n] = left;
+        return right;
+    }
+    node[n] = right;
+    return left;
+}
+
+/*
+ * @brief       :   sizes the tree for a number of sources and plays the first
+ *                  tournament, key and done of the sources must be set before.
+ *                  Missing leaves are exhausted sources
+ *
+ * @params      :   int
+ *                      sources :   number of real sources
+ *
+ * @returns     :   None
+ */
+void LoserTree::init(int sources)
+{
+    k = 1;
+    while (k < sources)
+    {
+        k <<= 1;
+    }
+    key.resize(k, 0);
+    done.resize(k, 1);
+    node.assign(k, 0);
+    node[0] = build(1);
+}
+
+/*
+ * @brief       :   replays the matches on the path of a source to the root,
+ *                  called after the head of the winner changed
+ *
+ * @params      :   int
+ *                      src     :   source whose head changed
+ *
+ * @returns     :   None
+ */
+void LoserTree::replay(int src)
+{
+    int winner = src;
+    for (int n = (src + k)/2; n >= 1; n /= 2)
+    {
+        if (less(node[n], winner))
+        {
+            swap(node[n], winner);
+        }
+    }
+    node[0] = winner;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   merges ranges of k sorted sequences with a loser tree
+ *
+ * @params      :   const int* const
+ *                      *seqs   :   first element of every sequence
+ *                  const long
+ *                      *lo     :   first element of the range of every sequence
+ *                      *hi     :   one past the last element of every range
+ *                  int
+ *                      k       :   number of sequences
+ *                  int
+ *                      *dst    :   output, hi - lo elements summed over all ranges
+ *
+ * @returns     :   None
+ */
+void multiway_merge(const int* const *seqs, const long *lo, const long *hi, int k, int *dst)
+{
+    vector<long> cur(lo, lo + k);
+    LoserTree tree;
+    tree.key.assign(k, 0);
+    tree.done.assign(k, 1);
+
+    for (int i = 0; i < k; i++)
+    {
+        if (cur[i] < hi[i])
+        {
+            tree.key[i] = seqs[i][cur[i]];
+            tree.done[i] = 0;
+        }
+    }
+    tree.init(k);
+
+    while (!tree.done[tree.node[0]])
+    {
+        int src = tree.node[0];
+        *dst++ = tree.key[src];
+        if (++cur[src] < hi[src])
+        {
+            tree.key[src] = seqs[src][cur[src]];
+        }
+        else
+        {
+            tree.done[src] = 1;
+        }
+        tree.replay(src);
+    }
+}
+
+/*EOF*/
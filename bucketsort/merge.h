@@ -0,0 +1,154 @@
+/*
+ *  @fileName       :   merge.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _MERGE_H_
+#define _MERGE_H_
+
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <cstdbool>
+
+/*Tree of losers over k sorted sources. Every internal node keeps the loser of the
+  match played there and node[0] keeps the overall winner, so replacing the winner
+  replays only the matches on its path to the root*/
+class LoserTree
+{
+    public:
+        int k;                      /*leaves, a power of two*/
+        std::vector<int> node;      /*node[0] is the winner, node[1..k-1] the losers*/
+        std::vector<int> key;       /*current head of every source*/
+        std::vector<char> done;     /*source is exhausted, loses every match*/
+
+        bool less(int a, int b);    //defined in merge.cpp
+
+        int build(int n);           //defined in merge.cpp
+
+        void init(int sources);     //defined in merge.cpp
+
+        void replay(int src);       //defined in merge.cpp
+};
+
+/*sorted sequences held in memory, as seen by multiway_split()*/
+class ArraySeqs
+{
+    public:
+        const int* const *seqs;     /*first element of every sequence*/
+        const long *lens;           /*elements of every sequence*/
+
+        long size(int i)            { return lens[i]; }
+        int at(int i, long j)       { return seqs[i][j]; }
+};
+
+/*
+ * @brief       :   binary search for the first element of a sequence which is
+ *                  not less than a value
+ *
+ * @params      :   Seqs&
+ *                      seqs    :   sorted sequences, with size(i) and at(i, j)
+ *                  int
+ *                      i       :   sequence to be searched
+ *                  long long
+ *                      val     :   value searched for, may be one past INT_MAX
+ *
+ * @returns     :   long
+ *                      index of the element, size of the sequence if there is none
+ */
+template <typename Seqs>
+long seq_lower_bound(Seqs& seqs, int i, long long val)
+{
+    long lo = 0;
+    long hi = seqs.size(i);
+    while (lo < hi)
+    {
+        long mid = lo + (hi - lo)/2;
+        if (seqs.at(i, mid) < val)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * @brief       :   multiway merge path. Finds how many elements of every sorted
+ *                  sequence come before a rank of the merged output, so that
+ *                  threads can merge disjoint slices of the output. The value
+ *                  of the element at the rank is found by a binary search over
+ *                  the int range, elements equal to it are taken from the lower
+ *                  sequences first
+ *
+ * @params      :   Seqs&
+ *                      seqs    :   sorted sequences, with size(i) and at(i, j)
+ *                  int
+ *                      k       :   number of sequences
+ *                  long
+ *                      rank    :   elements of the output before the split
+ *                      *pos    :   split position in every sequence, filled in
+ *
+ * @returns     :   None
+ */
+template <typename Seqs>
+void multiway_split(Seqs& seqs, int k, long rank, long *pos)
+{
+    long long lo = INT_MIN;
+    long long hi = INT_MAX;
+
+    for (int i = 0; i < k; i++)
+    {
+        pos[i] = 0;
+    }
+    if (rank <= 0)
+    {
+        return;
+    }
+
+    //smallest value v with at least rank elements <= v
+    while (lo < hi)
+    {
+        long long mid = lo + (hi - lo)/2;
+        long count = 0;
+        for (int i = 0; i < k; i++)
+        {
+            count += seq_lower_bound(seqs, i, mid + 1);
+        }
+        if (count >= rank)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+
+    //everything less than v comes first, ties fill up the rest in order
+    long need = rank;
+    std::vector<long> equal(k);
+    for (int i = 0; i < k; i++)
+    {
+        pos[i] = seq_lower_bound(seqs, i, lo);
+        equal[i] = seq_lower_bound(seqs, i, lo + 1) - pos[i];
+        need -= pos[i];
+    }
+    for (int i = 0; (i < k) && (need > 0); i++)
+    {
+        long take = (equal[i] < need) ? equal[i] : need;
+        pos[i] += take;
+        need -= take;
+    }
+}
+
+void multiway_merge(const int* const *seqs, const long *lo, const long *hi, int k, int *dst);
+
+#endif /*_MERGE_H_*/
@@ -0,0 +1,256 @@
+/*
+ *  @fileName       :   perf.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf.h"
+
+using namespace std;
+
+/*Private typedefs, classes, structs and unions*/
+typedef struct perfEventDesc
+{
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+}perfEventDesc_t;
+
+/*Global variables*/
+bool perfFlag = false;                  /*collect counters only when user asks for it*/
+static vector<perfSample_t> samples;    /*one sample per thread, indexed by threadId-1*/
+static thread_local int fds[PERF_NUM_EVENTS];   /*file descriptors of the calling thread*/
+
+/*event table, ordered as perf_events_t*/
+static const perfEventDesc_t events[PERF_NUM_EVENTS] =
+{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,          "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,        "instructions"},
+    {PERF_TYPE_HW_CACHE, (PERF_COUNT_HW_CACHE_L1D) |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), "L1D-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,        "LLC-misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,    "ctx-switches"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS,      "migrations"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,         "page-faults"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,          "task-clock(ns)"}
+};
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   opens a single counter for the calling thread, disabled
+ *
+ * @params      :   perfEventDesc_t
+ *                      *desc   :   event to be opened
+ *
+ * @returns     :   int
+ *                      file descriptor, -1 if the event is not available
+ */
+static int perf_open_event(const perfEventDesc_t *desc)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = desc->type;
+    attr.config = desc->config;
+    attr.disabled = 1;
+    attr.exclude_hv = 1;
+
+    //count this thread only, on whichever cpu it runs
+    int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if ((fd < 0) && (errno == EACCES || errno == EPERM))
+    {
+        //perf_event_paranoid does not allow kernel counting, retry user-only
+        attr.exclude_kernel = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   allocates the per-thread sample table
+ *
+ * @params      :   size_t
+ *                      numThreads  :   number of threads taking part
+ *
+ * @returns     :   None
+ */
+void perf_init(size_t numThreads)
+{
+    if (!perfFlag)
+    {
+        return;
+    }
+    samples.assign(numThreads, perfSample_t{});
+}
+
+/*
+ * @brief       :   opens all counters for the calling thread, hardware events
+ *                  which are not available are skipped and software events
+ *                  are still collected
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void perf_thread_open()
+{
+    if (!perfFlag)
+    {
+        return;
+    }
+    for (int i = 0; i < PERF_NUM_EVENTS; i++)
+    {
+        fds[i] = perf_open_event(&events[i]);
+    }
+}
+
+/*
+ * @brief       :   resets and enables counters of the calling thread
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void perf_thread_start()
+{
+    if (!perfFlag)
+    {
+        return;
+    }
+    for (int i = 0; i < PERF_NUM_EVENTS; i++)
+    {
+        if (fds[i] >= 0)
+        {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/*
+ * @brief       :   disables counters of the calling thread, stores their
+ *                  values and closes them
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void perf_thread_stop(size_t threadId)
+{
+    if (!perfFlag)
+    {
+        return;
+    }
+    //disable everything first so reading does not count itself
+    for (int i = 0; i < PERF_NUM_EVENTS; i++)
+    {
+        if (fds[i] >= 0)
+        {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    perfSample_t *s = &samples[threadId-1];
+    for (int i = 0; i < PERF_NUM_EVENTS; i++)
+    {
+        s->valid[i] = false;
+        s->value[i] = 0;
+        if (fds[i] >= 0)
+        {
+            uint64_t val;
+            if (read(fds[i], &val, sizeof(val)) == sizeof(val))
+            {
+                s->value[i] = val;
+                s->valid[i] = true;
+            }
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+/*
+ * @brief       :   prints counters of every thread followed by their sum
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void printPerfCounters()
+{
+    if (!perfFlag)
+    {
+        return;
+    }
+
+    perfSample_t total = {};
+    for (int e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+        total.valid[e] = !samples.empty();
+    }
+
+    printf("%-16s", "thread");
+    for (int e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+        printf("%16s", events[e].name);
+    }
+    printf("\n");
+
+    for (size_t t = 0; t < samples.size(); t++)
+    {
+        printf("%-16zu", t+1);
+        for (int e = 0; e < PERF_NUM_EVENTS; e++)
+        {
+            if (samples[t].valid[e])
+            {
+                printf("%16llu", (unsigned long long)samples[t].value[e]);
+                total.value[e] += samples[t].value[e];
+            }
+            else
+            {
+                printf("%16s", "n/a");
+                total.valid[e] = false;
+            }
+        }
+        printf("\n");
+    }
+
+    printf("%-16s", "total");
+    for (int e = 0; e < PERF_NUM_EVENTS; e++)
+    {
+        if (total.valid[e])
+        {
+            printf("%16llu", (unsigned long long)total.value[e]);
+        }
+        else
+        {
+            printf("%16s", "n/a");
+        }
+    }
+    printf("\n");
+
+    if (total.valid[PERF_CYCLES] && total.valid[PERF_INSTRUCTIONS] && total.value[PERF_CYCLES] != 0)
+    {
+        printf("IPC: %lf\n", (double)total.value[PERF_INSTRUCTIONS]/(double)total.value[PERF_CYCLES]);
+    }
+    else
+    {
+        printf("Hardware counters not available, only software events were collected\n");
+    }
+}
+
+/*EOF*/
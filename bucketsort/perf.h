@@ -0,0 +1,51 @@
+/*
+ *  @fileName       :   perf.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdbool>
+
+/*ENUMERATED LIST OF ALL HARDWARE & SOFTWARE EVENTS COLLECTED PER THREAD*/
+typedef enum perf_events
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_CTX_SWITCHES,
+    PERF_MIGRATIONS,
+    PERF_PAGE_FAULTS,
+    PERF_TASK_CLOCK,
+    PERF_NUM_EVENTS
+}perf_events_t;
+
+/*counter values recorded by one thread between the timing barriers*/
+typedef struct perfSample
+{
+    uint64_t value[PERF_NUM_EVENTS];
+    bool valid[PERF_NUM_EVENTS];
+}perfSample_t;
+
+extern bool perfFlag;   /*set by --perf, every perf_* call is a no-op otherwise*/
+
+void perf_init(size_t numThreads);
+
+void perf_thread_open();
+
+void perf_thread_start();
+
+void perf_thread_stop(size_t threadId);
+
+void printPerfCounters();
+
+#endif /*_PERF_H_*/
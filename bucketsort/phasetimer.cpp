@@ -0,0 +1,260 @@
+/*
+ *  @fileName       :   phasetimer.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <mutex>
+
+#include "phasetimer.h"
+#include "time.h"
+
+using namespace std;
+
+/*Private defines and macros*/
+#define CALIBRATE_MS    (20)    /*time the tick rate is measured against the monotonic clock*/
+
+/*Private typedefs, classes, structs and unions*/
+typedef struct phaseDesc
+{
+    const char *name;
+    bool serial;        /*run by the main thread only, no imbalance*/
+}phaseDesc_t;
+
+/*Global variables*/
+bool phaseFlag = false;                 /*time phases only when user asks for it*/
+static vector<phaseSample_t> samples;   /*one sample per thread, indexed by threadId-1*/
+static double nsPerTick = 1.0;          /*length of one tick, measured once*/
+
+/*phase table, ordered as phases_t*/
+static const phaseDesc_t phaseDescs[PHASE_NUM] =
+{
+    {"parse",       true},
+    {"classify",    false},
+    {"alloc",       false},
+    {"insert",      false},
+    {"sort",        false},
+    {"gather",      false},
+    {"merge",       false},
+    {"write",       true}
+};
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   measures the length of one tick against the monotonic clock,
+ *                  the time stamp counter runs at a constant rate on cpus with
+ *                  an invariant TSC
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+static void phase_calibrate()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    struct timespec t0, t1;
+    getTime(&t0);
+    uint64_t c0 = __rdtsc();
+    this_thread::sleep_for(chrono::milliseconds(CALIBRATE_MS));
+    getTime(&t1);
+    uint64_t c1 = __rdtsc();
+    if (c1 > c0)
+    {
+        nsPerTick = (double)elapsed_ns(&t0, &t1) / (double)(c1 - c0);
+    }
+#else
+    //phase_clock() already returns ns
+    nsPerTick = 1.0;
+#endif
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   clears the phase times of every thread, called before
+ *                  every input file
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void phase_reset()
+{
+    if (!phaseFlag)
+    {
+        return;
+    }
+    fill(samples.begin(), samples.end(), phaseSample_t{});
+}
+
+/*
+ * @brief       :   clears the parallel phases of every thread and keeps parse
+ *                  and write, called when the warmup sorts are done
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void phase_restart()
+{
+    if (!phaseFlag)
+    {
+        return;
+    }
+    for (phaseSample_t& sample : samples)
+    {
+        for (int p = 0; p < PHASE_NUM; p++)
+        {
+            if (!phaseDescs[p].serial)
+            {
+                sample.ticks[p] = 0;
+            }
+        }
+    }
+}
+
+/*
+ * @brief       :   makes room for the phase times of numThreads threads, times
+ *                  already recorded are kept. Measures the tick rate on the
+ *                  first call
+ *
+ * @params      :   size_t
+ *                      numThreads  :   number of threads taking part
+ *
+ * @returns     :   None
+ */
+void phase_init(size_t numThreads)
+{
+    if (!phaseFlag)
+    {
+        return;
+    }
+    static once_flag once;
+    call_once(once, phase_calibrate);
+
+    if (samples.size() < numThreads)
+    {
+        samples.resize(numThreads, phaseSample_t{});
+    }
+}
+
+/*
+ * @brief       :   adds the ticks since start to a phase of the calling thread
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *                  phases_t
+ *                      phase       :   phase that just ended
+ *                  uint64_t
+ *                      start       :   tick at which the phase began
+ *
+ * @returns     :   uint64_t
+ *                      current tick, the start of the next phase
+ */
+uint64_t phase_add(size_t threadId, phases_t phase, uint64_t start)
+{
+    if (!phaseFlag)
+    {
+        return 0;
+    }
+    uint64_t now = phase_clock();
+    samples[threadId-1].ticks[phase] += now - start;
+    return now;
+}
+
+/*
+ * @brief       :   prints the time every thread spent in every phase, in ms,
+ *                  followed by the slowest thread, the mean over the threads
+ *                  which ran the phase and their ratio. A ratio above 1 means
+ *                  threads waited for the slowest one at the end of the phase. Parse and write are
+ *                  done once, the other phases are the mean of one sort
+ *
+ * @params      :   int
+ *                      numRuns     :   number of measured sorts in the times
+ *
+ * @returns     :   None
+ */
+void printPhaseTimes(int numRuns)
+{
+    if (!phaseFlag || samples.empty())
+    {
+        return;
+    }
+
+    printf("Phase times (ms), %.0lf MHz tick", 1000.0 / nsPerTick);
+    if (numRuns > 1)
+    {
+        printf(", mean of %d sorts", numRuns);
+    }
+    printf("\n");
+    printf("%-16s", "thread");
+    for (int p = 0; p < PHASE_NUM; p++)
+    {
+        printf("%12s", phaseDescs[p].name);
+    }
+    printf("\n");
+
+    double maxMs[PHASE_NUM] = {};
+    double sumMs[PHASE_NUM] = {};
+    int ran[PHASE_NUM] = {};        /*threads which recorded the phase, a smaller sort leaves the others at 0*/
+    for (size_t t = 0; t < samples.size(); t++)
+    {
+        printf("%-16zu", t+1);
+        for (int p = 0; p < PHASE_NUM; p++)
+        {
+            double ms = samples[t].ticks[p] * nsPerTick / 1000000.0;
+            if (!phaseDescs[p].serial)
+            {
+                ms /= numRuns;
+            }
+            maxMs[p] = max(maxMs[p], ms);
+            sumMs[p] += ms;
+            ran[p] += (samples[t].ticks[p] > 0) ? 1 : 0;
+            printf("%12.3lf", ms);
+        }
+        printf("\n");
+    }
+
+    printf("%-16s", "max");
+    for (int p = 0; p < PHASE_NUM; p++)
+    {
+        printf("%12.3lf", maxMs[p]);
+    }
+    printf("\n");
+
+    printf("%-16s", "mean");
+    for (int p = 0; p < PHASE_NUM; p++)
+    {
+        if (phaseDescs[p].serial || ran[p] == 0)
+        {
+            printf("%12s", "n/a");
+        }
+        else
+        {
+            printf("%12.3lf", sumMs[p] / ran[p]);
+        }
+    }
+    printf("\n");
+
+    printf("%-16s", "imbalance");
+    for (int p = 0; p < PHASE_NUM; p++)
+    {
+        if (phaseDescs[p].serial || sumMs[p] == 0.0)
+        {
+            printf("%12s", "n/a");
+        }
+        else
+        {
+            printf("%12.2lf", maxMs[p] / (sumMs[p] / ran[p]));
+        }
+    }
+    printf("\n");
+}
+
+/*EOF*/
@@ -0,0 +1,82 @@
+/*
+ *  @fileName       :   phasetimer.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _PHASE_TIMER_H_
+#define _PHASE_TIMER_H_
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdbool>
+#include <ctime>
+
+#include "locks.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*ENUMERATED LIST OF ALL PHASES TIMED PER THREAD*/
+typedef enum phases
+{
+    PHASE_PARSE = 0,    /*reading the input file, main thread only*/
+    PHASE_CLASSIFY,     /*finding the bucket or digit of every element*/
+    PHASE_ALLOC,        /*sizing the buckets before the inserts*/
+    PHASE_INSERT,       /*moving elements to their buckets or digit offsets*/
+    PHASE_SORT,         /*sorting buckets, or ranges in the mergesort engine*/
+    PHASE_GATHER,       /*copying buckets back to the array, or merging ranges*/
+    PHASE_MERGE,        /*merging the runs of an external sort into the output file*/
+    PHASE_WRITE,        /*writing the output file, main thread only*/
+    PHASE_NUM
+}phases_t;
+
+/*ticks spent by one thread in every phase, one cache line per thread so that
+  threads do not write to each other's lines*/
+typedef struct alignas(CACHE_LINE_SIZE) phaseSample
+{
+    uint64_t ticks[PHASE_NUM];
+}phaseSample_t;
+
+extern bool phaseFlag;  /*set by --phases, every phase_* call is a no-op otherwise*/
+
+/*
+ * @brief       :   reads the time stamp counter, or the monotonic clock in ns
+ *                  where there is none
+ *
+ * @params      :   None
+ *
+ * @returns     :   uint64_t
+ *                      current tick, 0 unless --phases was given
+ */
+inline uint64_t phase_clock()
+{
+    if (!phaseFlag)
+    {
+        return 0;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+void phase_reset();
+
+void phase_restart();
+
+void phase_init(size_t numThreads);
+
+uint64_t phase_add(size_t threadId, phases_t phase, uint64_t start);
+
+void printPhaseTimes(int numRuns);
+
+#endif /*_PHASE_TIMER_H_*/
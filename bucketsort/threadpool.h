@@ -0,0 +1,44 @@
+/*
+ *  @fileName       :   threadpool.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <barrier>
+#include <functional>
+#include <cstdbool>
+
+/*work run by every thread of the pool, same signature as the worker functions,
+  may capture the state of the sort it belongs to*/
+typedef std::function<void*(size_t threadId)> pool_job_t;
+
+/*Persistent thread pool class definition. Workers are created once and park on
+  a barrier between jobs, the calling thread takes part in every job as thread 1*/
+class ThreadPool
+{
+    public:
+        std::vector<std::thread*> workers;  /*worker i runs as thread i+2*/
+        size_t numThreads;                  /*workers plus the calling thread*/
+        std::barrier<> *start;              /*workers wait here for the next job*/
+        std::barrier<> *done;               /*caller waits here until the job is done*/
+        pool_job_t job;                     /*job of the current run*/
+        size_t jobThreads;                  /*threads taking part in the current run*/
+        bool quit;                          /*set to make the workers exit*/
+
+        void run(pool_job_t fn, size_t n);  //defined in threadpool.cpp
+};
+
+ThreadPool* pool_create(size_t numThreads);
+
+void pool_destroy(ThreadPool *tp);
+
+#endif /*_THREADPOOL_H_*/
@@ -7,6 +7,9 @@
  *                                           
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "time.h"
 
 struct timespec startTime, endTime;
@@ -25,6 +28,21 @@ void getTime(struct timespec *dest)
     clock_gettime(CLOCK_MONOTONIC, dest);
 }
 
+/*
+ * @brief       :   returns the time between two recorded times
+ * 
+ * @parameters  :   const struct timespec 
+ *                      *start  :   earlier time
+ *                      *end    :   later time
+ *
+ * @returns     :   unsigned long long
+ *                      difference in ns
+ */
+unsigned long long elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec-start->tv_sec)*1000000000ull + (end->tv_nsec-start->tv_nsec);
+}
+
 /*
  * @brief       :   prints difference between time recorded in two sructs 
  * 
@@ -34,11 +52,67 @@ void getTime(struct timespec *dest)
  */
 void printTimeDifference()
 {
-    unsigned long long elapsed_ns;
-    elapsed_ns = (endTime.tv_sec-startTime.tv_sec)*1000000000 + (endTime.tv_nsec-startTime.tv_nsec);
-    printf("Elapsed (ns): %llu\n",elapsed_ns);
-    double elapsed_s = ((double)elapsed_ns)/1000000000.0;
+    unsigned long long elapsedNs = elapsed_ns(&startTime, &endTime);
+    printf("Elapsed (ns): %llu\n",elapsedNs);
+    double elapsed_s = ((double)elapsedNs)/1000000000.0;
     printf("Elapsed (s): %lf\n",elapsed_s);
 }
 
+/*
+ * @brief       :   prints min, median, mean, standard deviation and the 95%
+ *                  confidence interval of the mean of repeated runs. The
+ *                  interval uses Student's t for up to 30 degrees of freedom
+ *                  and the normal distribution above that
+ * 
+ * @parameters  :   std::vector<unsigned long long>
+ *                      samples :   elapsed time of every measured run, in ns
+ *                  int
+ *                      warmup  :   runs done before the samples, not measured
+ *
+ * @returns     :   none
+ */
+void printTimeStats(std::vector<unsigned long long> samples, int warmup)
+{
+    //two-sided 95% critical values of Student's t, indexed by degrees of freedom
+    static const double tCrit[31] =
+    {
+        0.0,    12.706, 4.303,  3.182,  2.776,  2.571,  2.447,  2.365,  2.306,  2.262,
+        2.228,  2.201,  2.179,  2.160,  2.145,  2.131,  2.120,  2.110,  2.101,  2.093,
+        2.086,  2.080,  2.074,  2.069,  2.064,  2.060,  2.056,  2.052,  2.048,  2.045,
+        2.042
+    };
+
+    size_t n = samples.size();
+    if (n == 0)
+    {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double mean = 0.0;
+    for (unsigned long long s : samples)
+    {
+        mean += (double)s;
+    }
+    mean /= n;
+
+    double var = 0.0;
+    for (unsigned long long s : samples)
+    {
+        var += ((double)s - mean) * ((double)s - mean);
+    }
+    double stddev = (n > 1) ? std::sqrt(var / (n - 1)) : 0.0;
+
+    double median = (n % 2) ? (double)samples[n/2] : ((double)samples[n/2 - 1] + (double)samples[n/2]) / 2.0;
+    double half = (n > 1) ? ((n - 1 <= 30) ? tCrit[n - 1] : 1.960) * stddev / std::sqrt((double)n) : 0.0;
+
+    printf("Runs: %zu, warmup runs: %d\n", n, warmup);
+    printf("Min (ns): %llu\n", samples[0]);
+    printf("Median (ns): %.0lf\n", median);
+    printf("Mean (ns): %.0lf\n", mean);
+    printf("Stddev (ns): %.0lf\n", stddev);
+    printf("95%% CI of mean (ns): %.0lf - %.0lf\n", mean - half, mean + half);
+    printf("Mean (s): %lf\n", mean/1000000000.0);
+}
+
 /*EOF*/
\ No newline at end of file
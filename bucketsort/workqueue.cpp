@@ -0,0 +1,104 @@
+/*
+ *  @fileName       :   workqueue.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include "workqueue.h"
+#include "locks.h"
+
+using namespace std;
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Pushes a task at the bottom of the deque, called by the owner
+ *
+ * @params      :   sortTask_t
+ *                      *task   :   task to be pushed
+ * 
+ * @returns     :   bool
+ *                      false if the deque is full
+ */
+bool WSDeque::push(sortTask_t *task)
+{
+    long b = bottom.load(RELAXED);
+    long t = top.load(ACQUIRE);
+    if (b - t > mask)
+    {
+        return false;
+    }
+    tasks[b & mask].store(task, RELAXED);
+    //publish the task before thieves can see the new bottom
+    bottom.store(b + 1, RELEASE_STORE);
+    return true;
+}
+
+/*
+ * @brief       :   Pops the most recently pushed task, called by the owner
+ *
+ * @params      :   None
+ * 
+ * @returns     :   sortTask_t*
+ *                      task, NULL if the deque is empty
+ */
+sortTask_t* WSDeque::pop()
+{
+    long b = bottom.load(RELAXED) - 1;
+    bottom.store(b, RELAXED);
+    //thieves must see the reserved slot before we read top
+    atomic_thread_fence(SEQ_CST);
+    long t = top.load(RELAXED);
+
+    if (t > b)
+    {
+        //deque was empty
+        bottom.store(b + 1, RELAXED);
+        return NULL;
+    }
+
+    sortTask_t *task = tasks[b & mask].load(RELAXED);
+    if (t == b)
+    {
+        //last task, race against thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, SEQ_CST, RELAXED))
+        {
+            task = NULL;
+        }
+        bottom.store(b + 1, RELAXED);
+    }
+    return task;
+}
+
+/*
+ * @brief       :   Steals the oldest task, called by any thread but the owner
+ *
+ * @params      :   None
+ * 
+ * @returns     :   sortTask_t*
+ *                      task, NULL if the deque is empty or another thread won
+ *                      the race for the task
+ */
+sortTask_t* WSDeque::steal()
+{
+    long t = top.load(ACQUIRE);
+    atomic_thread_fence(SEQ_CST);
+    long b = bottom.load(ACQUIRE);
+
+    if (t >= b)
+    {
+        return NULL;
+    }
+
+    sortTask_t *task = tasks[t & mask].load(RELAXED);
+    if (!top.compare_exchange_strong(t, t + 1, SEQ_CST, RELAXED))
+    {
+        return NULL;
+    }
+    return task;
+}
+
+/*EOF*/
@@ -0,0 +1,42 @@
+/*
+ *  @fileName       :   workqueue.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _WORKQUEUE_H_
+#define _WORKQUEUE_H_
+
+#include <iostream>
+#include <atomic>
+#include <cstdbool>
+
+/*range [lo, hi) of one bucket that is still to be sorted*/
+typedef struct sortTask
+{
+    int bucket;
+    int lo;
+    int hi;
+}sortTask_t;
+
+/*Chase-Lev work-stealing deque class definition. The owner pushes and pops at the
+  bottom, other threads steal from the top. Capacity is fixed and a power of two*/
+class alignas(64) WSDeque
+{
+    public:
+        std::atomic<long> top;              /*next task to be stolen*/
+        std::atomic<long> bottom;           /*next free slot of the owner*/
+        std::atomic<sortTask_t*> *tasks;    /*circular buffer of task pointers*/
+        long mask;                          /*capacity - 1*/
+
+        bool push(sortTask_t *task);    //defined in workqueue.cpp
+
+        sortTask_t* pop();              //defined in workqueue.cpp
+
+        sortTask_t* steal();            //defined in workqueue.cpp
+};
+
+#endif /*_WORKQUEUE_H_*/
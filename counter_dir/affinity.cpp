@@ -0,0 +1,393 @@
+/*
+ *  @fileName       :   affinity.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+
+#include "affinity.h"
+
+using namespace std;
+
+/*Private defines and macros*/
+#define SYSFS_CPU   "/sys/devices/system/cpu/"
+#define SYSFS_NODE  "/sys/devices/system/node/"
+
+/*Global variables*/
+vector<cpuInfo_t> topology;             /*all online cpus, ordered by cpu number*/
+static vector<int> pinOrder;            /*cpu assigned to thread i is pinOrder[i % size]*/
+static pin_policy_t pinPolicy = PIN_NONE;
+int simulatedNodes = 0;                 /*split threads into this many groups instead of real nodes*/
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   reads a single integer from a sysfs file
+ *
+ * @params      :   string
+ *                      path    :   path to the file
+ *                  int
+ *                      dflt    :   value returned if the file cannot be read
+ *
+ * @returns     :   int
+ *                      value read from the file
+ */
+static int read_sysfs_int(string path, int dflt)
+{
+    ifstream fin(path);
+    int val;
+    if (!(fin >> val))
+    {
+        return dflt;
+    }
+    return val;
+}
+
+/*
+ * @brief       :   parses a cpu list in sysfs format, e.g. "0,2,4-7"
+ *
+ * @params      :   string
+ *                      list    :   list to be parsed
+ *                  vector<int>&
+ *                      cpus    :   parsed cpu numbers are appended here
+ *
+ * @returns     :   bool
+ *                      false if the list is malformed
+ */
+bool parse_cpulist(string list, vector<int>& cpus)
+{
+    stringstream ss(list);
+    string range;
+
+    while (getline(ss, range, ','))
+    {
+        if (range.empty() || range == "\n")
+        {
+            continue;
+        }
+        size_t dash = range.find('-');
+        try
+        {
+            if (dash == string::npos)
+            {
+                cpus.push_back(stoi(range));
+            }
+            else
+            {
+                int lo = stoi(range.substr(0, dash));
+                int hi = stoi(range.substr(dash+1));
+                for (int c = lo; c <= hi; c++)
+                {
+                    cpus.push_back(c);
+                }
+            }
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   reads socket, core, numa node and SMT index of every online
+ *                  cpu from sysfs, missing entries default to a single socket
+ *                  and a single node
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+static void topology_read()
+{
+    vector<int> online;
+    ifstream fin(SYSFS_CPU "online");
+    string list;
+    if (!(fin >> list) || !parse_cpulist(list, online) || online.empty())
+    {
+        //no sysfs, assume cpus 0..n-1
+        online.clear();
+        for (unsigned c = 0; c < thread::hardware_concurrency(); c++)
+        {
+            online.push_back(c);
+        }
+    }
+
+    //map every cpu to its numa node
+    map<int, int> nodeOf;
+    for (int n = 0; ; n++)
+    {
+        ifstream nfin(SYSFS_NODE "node" + to_string(n) + "/cpulist");
+        string nlist;
+        if (!nfin)
+        {
+            break;
+        }
+        vector<int> ncpus;
+        if ((nfin >> nlist) && parse_cpulist(nlist, ncpus))
+        {
+            for (int c : ncpus)
+            {
+                nodeOf[c] = n;
+            }
+        }
+    }
+
+    map<pair<int,int>, int> smtCount;   //(package, core) -> siblings seen so far
+    for (int c : online)
+    {
+        string base = SYSFS_CPU "cpu" + to_string(c) + "/topology/";
+        cpuInfo_t info;
+        info.cpu = c;
+        info.package = read_sysfs_int(base + "physical_package_id", 0);
+        info.core = read_sysfs_int(base + "core_id", c);
+        info.node = nodeOf.count(c) ? nodeOf[c] : 0;
+        info.smt = smtCount[{info.package, info.core}]++;
+        topology.push_back(info);
+    }
+}
+
+/*
+ * @brief       :   reads the topology on the first call, sorters running on
+ *                  different threads may call it at the same time
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void topology_init()
+{
+    static once_flag once;
+    call_once(once, topology_read);
+}
+
+/*
+ * @brief       :   returns numa node of a cpu
+ *
+ * @params      :   int
+ *                      cpu     :   logical cpu number
+ *
+ * @returns     :   int
+ *                      numa node, 0 if the cpu is unknown
+ */
+int topology_node_of_cpu(int cpu)
+{
+    topology_init();
+    for (cpuInfo_t& info : topology)
+    {
+        if (info.cpu == cpu)
+        {
+            return info.node;
+        }
+    }
+    return 0;
+}
+
+/*
+ * @brief       :   returns number of numa nodes with online cpus
+ *
+ * @params      :   None
+ *
+ * @returns     :   int
+ *                      number of nodes, at least 1
+ */
+int topology_num_nodes()
+{
+    topology_init();
+    int maxNode = 0;
+    for (cpuInfo_t& info : topology)
+    {
+        maxNode = max(maxNode, info.node);
+    }
+    return maxNode + 1;
+}
+
+/*
+ * @brief       :   returns number of nodes used by hierarchical locks, either
+ *                  simulated with --nodes or the real numa nodes
+ *
+ * @params      :   None
+ *
+ * @returns     :   int
+ *                      number of nodes, at least 1
+ */
+int topology_lock_nodes()
+{
+    if (simulatedNodes > 0)
+    {
+        return simulatedNodes;
+    }
+    return topology_num_nodes();
+}
+
+/*
+ * @brief       :   maps a thread to a node for hierarchical locks. With --nodes
+ *                  threads are split into contiguous groups, otherwise the node
+ *                  of the pinned cpu, or of the cpu the thread currently runs
+ *                  on, is used
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *                      numThreads  :   number of threads taking part
+ *
+ * @returns     :   int
+ *                      node in range [0, topology_lock_nodes())
+ */
+int topology_node_of_thread(size_t threadId, size_t numThreads)
+{
+    if (simulatedNodes > 0)
+    {
+        return (int)(((threadId-1) * simulatedNodes) / numThreads);
+    }
+
+    int cpu = pin_cpu_of_thread(threadId);
+    if (cpu < 0)
+    {
+        cpu = sched_getcpu();
+    }
+    return topology_node_of_cpu(cpu);
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   reads the topology and computes the cpu order in which
+ *                  threads will be pinned. Called by the main thread before
+ *                  any worker runs
+ *
+ * @params      :   pin_policy_t
+ *                      policy  :   placement policy
+ *                  string
+ *                      cpulist :   explicit cpu list, used with PIN_LIST
+ *
+ * @returns     :   bool
+ *                      false if the cpu list is malformed or empty
+ */
+bool pin_init(pin_policy_t policy, string cpulist)
+{
+    //read the topology here, workers only look it up
+    topology_init();
+
+    pinPolicy = policy;
+    pinOrder.clear();
+
+    if (policy == PIN_NONE)
+    {
+        return true;
+    }
+
+    if (policy == PIN_LIST)
+    {
+        if (!parse_cpulist(cpulist, pinOrder) || pinOrder.empty())
+        {
+            pinPolicy = PIN_NONE;
+            return false;
+        }
+    }
+    else
+    {
+        topology_init();
+
+        //rank of every core within its socket, so scatter can
+        //interleave sockets that number their cores differently
+        map<pair<int,int>, int> coreRank;
+        map<int, int> coresInPackage;
+        vector<cpuInfo_t> cpus = topology;
+        sort(cpus.begin(), cpus.end(), [](const cpuInfo_t& a, const cpuInfo_t& b)
+        {
+            return make_tuple(a.package, a.core, a.smt) < make_tuple(b.package, b.core, b.smt);
+        });
+        for (cpuInfo_t& info : cpus)
+        {
+            if (!coreRank.count({info.package, info.core}))
+            {
+                coreRank[{info.package, info.core}] = coresInPackage[info.package]++;
+            }
+        }
+
+        if (policy == PIN_SCATTER)
+        {
+            stable_sort(cpus.begin(), cpus.end(), [&](const cpuInfo_t& a, const cpuInfo_t& b)
+            {
+                return make_tuple(a.smt, coreRank[{a.package, a.core}], a.package) <
+                       make_tuple(b.smt, coreRank[{b.package, b.core}], b.package);
+            });
+        }
+
+        for (cpuInfo_t& info : cpus)
+        {
+            pinOrder.push_back(info.cpu);
+        }
+    }
+
+    cout << "Pinning threads to cpus:";
+    for (int c : pinOrder)
+    {
+        cout << " " << c;
+    }
+    cout << endl;
+    return true;
+}
+
+/*
+ * @brief       :   returns the cpu a thread is pinned to
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   int
+ *                      cpu number, -1 if threads are not pinned
+ */
+int pin_cpu_of_thread(size_t threadId)
+{
+    if (pinPolicy == PIN_NONE || pinOrder.empty())
+    {
+        return -1;
+    }
+    return pinOrder[(threadId-1) % pinOrder.size()];
+}
+
+/*
+ * @brief       :   pins the calling thread according to the selected policy
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void pin_thread(size_t threadId)
+{
+    int cpu = pin_cpu_of_thread(threadId);
+    if (cpu < 0)
+    {
+        return;
+    }
+    if (cpu >= CPU_SETSIZE)
+    {
+        cout << "Failed to pin thread " << threadId << " to cpu " << cpu << endl;
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        cout << "Failed to pin thread " << threadId << " to cpu " << cpu << endl;
+    }
+}
+
+/*EOF*/
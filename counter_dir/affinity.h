@@ -0,0 +1,58 @@
+/*
+ *  @fileName       :   affinity.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _AFFINITY_H_
+#define _AFFINITY_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdbool>
+
+/*ENUMERATED LIST OF ALL AVAILABLE THREAD PLACEMENT POLICIES*/
+typedef enum pin_policies
+{
+    PIN_NONE = 0,       /*let the scheduler place threads*/
+    PIN_COMPACT,        /*fill SMT siblings, then cores, then sockets*/
+    PIN_SCATTER,        /*spread over sockets, then cores, SMT siblings last*/
+    PIN_LIST            /*explicit list of cpus given by the user*/
+}pin_policy_t;
+
+/*topology of one online cpu, read from sysfs*/
+typedef struct cpuInfo
+{
+    int cpu;            /*logical cpu number*/
+    int package;        /*physical socket*/
+    int core;           /*core id within the socket*/
+    int node;           /*numa node*/
+    int smt;            /*index of this hardware thread within its core*/
+}cpuInfo_t;
+
+extern std::vector<cpuInfo_t> topology;    /*all online cpus, ordered by cpu number*/
+extern int simulatedNodes;                  /*set by --nodes, 0 uses the real numa topology*/
+
+void topology_init();
+
+int topology_node_of_cpu(int cpu);
+
+int topology_num_nodes();
+
+int topology_lock_nodes();
+
+int topology_node_of_thread(size_t threadId, size_t numThreads);
+
+bool parse_cpulist(std::string list, std::vector<int>& cpus);
+
+bool pin_init(pin_policy_t policy, std::string cpulist);
+
+int pin_cpu_of_thread(size_t threadId);
+
+void pin_thread(size_t threadId);
+
+#endif /*_AFFINITY_H_*/
@@ -10,27 +10,152 @@
 /*LIBRARY FILES*/
 #include "counter.h"
 #include "time.h"
+#include "perf.h"
+#include "affinity.h"
+#include "threadpool.h"
+#include "locktrace.h"
 
 using namespace std; 
 
-/*GLOBAL VARIABLES */
-static vector<thread*> threads;         /*vector of threads*/
-int ctr = 0;                            /*global counter to be incremented*/
-int numIterations = 0;                  /*number of times each thread will increment the counter*/
-int num_threads=4;                      /*number of threads, 4 by default*/   
-
-TAS *taslock;                           /*pointer to TAS lock implementation class*/
-TTAS *ttaslock;                         /*pointer to TTAS lock implementation class*/
-TicketLock *tktlock;                    /*pointer to Ticket lock implementation class*/
-MCS *mcslock;                           /*pointer to MCS lock implementation class*/
-mutex *mutexlock;                       /*pointer to Mutex lock implementation class*/
-Peterson *petersonseqlock;              /*pointer to Peterson lock implementation class, used for sequential consistency*/
-Peterson *petersonrellock;              /*pointer to Peterson lock implementation class, used for released consistency*/
-Barrier *sensebar;                      /*pointer to sense reversal barrier implementation class*/
-barrier<> *pthreadbar;                  /*pointer to pthread barrier implementation class*/
-
-lock_algs_t locktype = PTHREAD_algorithm;   /*locking algorithm to be used, mutex default*/
-barrier_types_t bartype = PTHREAD_type;     /*barrier type to be used, pthread barrier default*/
+/*Private typedefs, classes, structs and unions*/
+/*statistic updated by writers and snapshotted by readers in STATS_mode,
+  fields are relaxed atomics so that seqlock readers may race with writers*/
+typedef struct counterStats
+{
+    atomic<long> count;
+    atomic<long> sum;
+    atomic<long> min;
+    atomic<long> max;
+}counterStats_t;
+
+/*one cache line of the data guarded by a lock of LOCK_mode*/
+typedef struct alignas(CACHE_LINE_SIZE) guardedLine
+{
+    long word[CACHE_LINE_SIZE / sizeof(long)];
+}guardedLine_t;
+
+/*one lock of LOCK_mode, padded to its own cache line so that the numLocks locks
+  of an array do not share lines*/
+template <class L>
+class alignas(CACHE_LINE_SIZE) LockSlot : public L
+{
+};
+
+/*State of one counter. The counter, every lock, barrier, buffer and the thread
+  pool belong to the counter, so runs do not see anything left over by an
+  earlier run*/
+class CounterEngine
+{
+    public:
+        ThreadPool *pool;                       /*workers of this counter, created on first use*/
+        struct timespec startTime, endTime;     /*timed region of the last run*/
+
+        int ctr;                                /*counter to be incremented*/
+        int numIterations;                      /*number of times each thread will increment the counter*/
+        int num_threads;                        /*number of threads of the current run*/
+
+        LockSlot<TAS> *taslock;                 /*pointer to TAS lock implementation class*/
+        LockSlot<TTAS> *ttaslock;               /*pointer to TTAS lock implementation class*/
+        LockSlot<TicketLock> *tktlock;          /*pointer to Ticket lock implementation class*/
+        LockSlot<MCS> *mcslock;                 /*pointer to MCS lock implementation class*/
+        LockSlot<mutex> *mutexlock;             /*pointer to Mutex lock implementation class*/
+        LockSlot<Peterson> *petersonseqlock;    /*pointer to Peterson lock implementation class, used for sequential consistency*/
+        LockSlot<Peterson> *petersonrellock;    /*pointer to Peterson lock implementation class, used for released consistency*/
+        LockSlot<CohortBOMCS> *cbomcslock;      /*pointer to C-BO-MCS cohort lock implementation class*/
+        LockSlot<CohortTktTkt> *ctktlock;       /*pointer to C-TKT-TKT cohort lock implementation class*/
+        LockSlot<TimeoutCLH> *clhlock;          /*pointer to timeout CLH lock implementation class*/
+        Barrier *sensebar;                      /*pointer to sense reversal barrier implementation class*/
+        barrier<> *pthreadbar;                  /*pointer to pthread barrier implementation class*/
+
+        CentralRWLock *centralrwlock;           /*pointer to centralized reader-writer lock implementation class*/
+        PhaseFairRWLock *pfrwlock;              /*pointer to phase-fair reader-writer lock implementation class*/
+        DistRWLock *distrwlock;                 /*pointer to distributed reader-writer lock implementation class*/
+
+        lock_algs_t locktype;                   /*locking algorithm of the current run*/
+        barrier_types_t bartype;                /*barrier type of the current run*/
+        lockTrace_t *lockTraces;                /*contention tracing state of every lock, with --lock-trace*/
+
+        int numLocks;                           /*instances of the selected lock, only LOCK_mode uses more than one*/
+        vector<double> lockCdf;                 /*probability of picking lock 0..l, Zipf distributed*/
+        int csLines;                            /*extra cache lines written in every critical section*/
+        vector<guardedLine_t> guarded;          /*csLines+1 lines per lock, the first word of the first line is its count*/
+        think_dists_t thinkDist;                /*distribution of the think time*/
+        int thinkNs;                            /*mean think time, 0 for none*/
+        int burst;                              /*acquisitions between two think times*/
+        rwlock_types_t rwtype;                  /*reader-writer lock of the current run*/
+        int readPercent;                        /*percentage of iterations that only read the counter*/
+        stats_guards_t statsguard;              /*guard of the statistic*/
+        int numWriters;                         /*threads updating the statistic*/
+
+        counterStats_t stats;                   /*statistic of STATS_mode*/
+        SeqLock *seqlock;                       /*pointer to sequence lock guarding the statistic*/
+        mutex *statsmutex;                      /*pointer to mutex guarding the statistic*/
+        atomic<long> snapshotsTaken;            /*snapshots read by all readers*/
+        atomic<long> snapshotsTorn;             /*snapshots which were not consistent*/
+
+        pipe_types_t pipetype;                  /*blocking primitive of the buffer*/
+        int numProducers;                       /*producer threads of the current run*/
+        int pipeRing[PIPE_DEPTH];               /*bounded buffer of PIPE_mode, guarded by the selected lock*/
+        int pipeHead, pipeTail, pipeCount;      /*next item to take, next free slot, items in the buffer*/
+        CondVar *notFull;                       /*pointer to condition variable signalled when a slot is freed*/
+        CondVar *notEmpty;                      /*pointer to condition variable signalled when an item is added*/
+        Semaphore *slotsSem;                    /*pointer to semaphore counting free slots*/
+        Semaphore *itemsSem;                    /*pointer to semaphore counting items*/
+        atomic<int> producersLeft;              /*producers which have not finished yet*/
+
+        void TAS_init();                    //locks and barriers, defined below
+        void TAS_delete();
+        void TTAS_init();
+        void TTAS_delete();
+        void TicketLock_init();
+        void TicketLock_delete();
+        void MCS_init();
+        void MCS_delete();
+        void mutex_init();
+        void mutex_delete();
+        void petersonSeq_init();
+        void petersonSeq_delete();
+        void petersonRel_init();
+        void petersonRel_delete();
+        void cohortBOMCS_init();
+        void cohortBOMCS_delete();
+        void cohortTktTkt_init();
+        void cohortTktTkt_delete();
+        void timeoutCLH_init();
+        void timeoutCLH_delete();
+        void lock_init(lock_algs_t alg);
+        void lock_delete(lock_algs_t alg);
+        void rwlock_init(rwlock_types_t rw, size_t numThreads);
+        void rwlock_delete(rwlock_types_t rw);
+        void pthread_barrier_init(size_t num_threads);
+        void pthread_barrier_delete();
+        void sense_barrier_init(size_t num_threads);
+        void sense_barrier_delete();
+        void barrier_init(size_t num_threads, barrier_types_t bar);
+        void barrier_delete(barrier_types_t bar);
+
+        void stats_init(stats_guards_t guard);  //state of the workloads, defined below
+        void stats_delete(stats_guards_t guard);
+        void pipe_init(pipe_types_t pipe, int producers);
+        void pipe_delete(pipe_types_t pipe);
+        template <class L>
+        void pipe_put(L& lock, int item);
+        template <class L>
+        int pipe_get(L& lock);
+        void pipe_put_item(int item);
+        int pipe_get_item();
+
+        void workload_init(const counterConfig_t& config);  //shape of LOCK_mode, defined below
+
+        void* counter_lock(size_t threadId);    //worker functions, defined below
+        void* counter_barrier(size_t threadId);
+        void* counter_rwlock(size_t threadId);
+        void* counter_stats(size_t threadId);
+        void* counter_pipe(size_t threadId);
+
+        void pool_run(pool_job_t fn, size_t numThreads);    //entry points, defined below
+        counterResult_t run(const counterConfig_t& config);
+};
 
 /*---------------------------------------------------------------------------------*/
 /*
@@ -40,11 +165,13 @@ barrier_types_t bartype = PTHREAD_type;     /*barrier type to be used, pthread b
  * 
  * @returns     :   None
  */
-static void TAS_init()
+void CounterEngine::TAS_init()
 {
-    //we will lock each bucket individually
-    taslock = new TAS;
-    taslock->taslock.store(false, SEQ_CST);
+    taslock = new LockSlot<TAS>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        taslock[l].taslock.store(false, SEQ_CST);
+    }
 }
 
 /*
@@ -54,9 +181,9 @@ static void TAS_init()
  * 
  * @returns     :   None
  */
-static void TAS_delete()
+void CounterEngine::TAS_delete()
 {
-    delete taslock;
+    delete[] taslock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -66,10 +193,13 @@ static void TAS_delete()
  * 
  * @returns     :   None
  */
-static void TTAS_init()
+void CounterEngine::TTAS_init()
 {
-    ttaslock = new TTAS;
-    ttaslock->ttaslock.store(false, SEQ_CST);
+    ttaslock = new LockSlot<TTAS>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        ttaslock[l].ttaslock.store(false, SEQ_CST);
+    }
 }
 
 /*
@@ -79,9 +209,9 @@ static void TTAS_init()
  * 
  * @returns     :   None
  */
-static void TTAS_delete()
+void CounterEngine::TTAS_delete()
 {
-    delete ttaslock;
+    delete[] ttaslock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -91,11 +221,14 @@ static void TTAS_delete()
  * 
  * @returns     :   None
  */
-static void TicketLock_init()
+void CounterEngine::TicketLock_init()
 {
-    tktlock = new TicketLock;
-    tktlock->next_num.store(0, SEQ_CST);
-    tktlock->now_serving.store(0, SEQ_CST);
+    tktlock = new LockSlot<TicketLock>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        tktlock[l].next_num.store(0, SEQ_CST);
+        tktlock[l].now_serving.store(0, SEQ_CST);
+    }
 }
 
 /*
@@ -105,9 +238,9 @@ static void TicketLock_init()
  * 
  * @returns     :   None
  */
-static void TicketLock_delete()
+void CounterEngine::TicketLock_delete()
 {
-    delete tktlock;
+    delete[] tktlock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -117,10 +250,13 @@ static void TicketLock_delete()
  * 
  * @returns     :   None
  */
-static void MCS_init()
+void CounterEngine::MCS_init()
 {
-    mcslock = new MCS;
-    mcslock->tail.store(NULL, SEQ_CST);
+    mcslock = new LockSlot<MCS>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        mcslock[l].tail.store(NULL, SEQ_CST);
+    }
 }
 
 /*
@@ -130,9 +266,9 @@ static void MCS_init()
  * 
  * @returns     :   None
  */
-static void MCS_delete()
+void CounterEngine::MCS_delete()
 {
-    delete mcslock;
+    delete[] mcslock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -142,9 +278,9 @@ static void MCS_delete()
  * 
  * @returns     :   None
  */
-static void mutex_init()
+void CounterEngine::mutex_init()
 {
-    mutexlock = new mutex;
+    mutexlock = new LockSlot<mutex>[numLocks];
 }
 /*
  * @brief       :   Deletes the pointer to mutex lock implementation
@@ -153,9 +289,9 @@ static void mutex_init()
  * 
  * @returns     :   None
  */
-static void mutex_delete()
+void CounterEngine::mutex_delete()
 {
-    delete mutexlock;
+    delete[] mutexlock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -166,12 +302,15 @@ static void mutex_delete()
  * 
  * @returns     :   None
  */
-static void petersonSeq_init()
+void CounterEngine::petersonSeq_init()
 {
-    petersonseqlock = new Peterson;
-    petersonseqlock->desires[0].store(false, SEQ_CST);
-    petersonseqlock->desires[1].store(false, SEQ_CST);
-    petersonseqlock->turn.store(0, SEQ_CST);
+    petersonseqlock = new LockSlot<Peterson>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        petersonseqlock[l].desires[0].store(false, SEQ_CST);
+        petersonseqlock[l].desires[1].store(false, SEQ_CST);
+        petersonseqlock[l].turn.store(0, SEQ_CST);
+    }
 }
 
 /*
@@ -182,9 +321,9 @@ static void petersonSeq_init()
  * 
  * @returns     :   None
  */
-static void petersonSeq_delete()
+void CounterEngine::petersonSeq_delete()
 {
-    delete petersonseqlock;
+    delete[] petersonseqlock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
@@ -195,12 +334,15 @@ static void petersonSeq_delete()
  * 
  * @returns     :   None
  */
-static void petersonRel_init()
+void CounterEngine::petersonRel_init()
 {
-    petersonrellock = new Peterson;
-    petersonrellock->desires[0].store(false, SEQ_CST);
-    petersonrellock->desires[1].store(false, SEQ_CST);
-    petersonrellock->turn.store(0, SEQ_CST);
+    petersonrellock = new LockSlot<Peterson>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        petersonrellock[l].desires[0].store(false, SEQ_CST);
+        petersonrellock[l].desires[1].store(false, SEQ_CST);
+        petersonrellock[l].turn.store(0, SEQ_CST);
+    }
 }
 
 /*
@@ -211,20 +353,141 @@ static void petersonRel_init()
  * 
  * @returns     :   None
  */
-static void petersonRel_delete()
+void CounterEngine::petersonRel_delete()
+{
+    delete[] petersonrellock;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to C-BO-MCS cohort lock implementation
+ *                  with one local MCS lock per node
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::cohortBOMCS_init()
+{
+    cbomcslock = new LockSlot<CohortBOMCS>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        CohortBOMCS *lock = &cbomcslock[l];
+        lock->global.bolock.store(false, SEQ_CST);
+        lock->numNodes = topology_lock_nodes();
+        lock->passBound = cohortPassBound;
+        lock->cohorts = new MCSCohort[lock->numNodes];
+        for (int i = 0; i < lock->numNodes; i++)
+        {
+            lock->cohorts[i].local.tail.store(NULL, SEQ_CST);
+            lock->cohorts[i].ownsGlobal = false;
+            lock->cohorts[i].passCount = 0;
+        }
+    }
+}
+
+/*
+ * @brief       :   Deletes the pointer to C-BO-MCS cohort lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::cohortBOMCS_delete()
+{
+    for (int l = 0; l < numLocks; l++)
+    {
+        delete[] cbomcslock[l].cohorts;
+    }
+    delete[] cbomcslock;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to C-TKT-TKT cohort lock implementation
+ *                  with one local ticket lock per node
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::cohortTktTkt_init()
 {
-    delete petersonrellock;
+    ctktlock = new LockSlot<CohortTktTkt>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        CohortTktTkt *lock = &ctktlock[l];
+        lock->global.next_num.store(0, SEQ_CST);
+        lock->global.now_serving.store(0, SEQ_CST);
+        lock->numNodes = topology_lock_nodes();
+        lock->passBound = cohortPassBound;
+        lock->cohorts = new TicketCohort[lock->numNodes];
+        for (int i = 0; i < lock->numNodes; i++)
+        {
+            lock->cohorts[i].local.next_num.store(0, SEQ_CST);
+            lock->cohorts[i].local.now_serving.store(0, SEQ_CST);
+            lock->cohorts[i].ownsGlobal = false;
+            lock->cohorts[i].passCount = 0;
+        }
+    }
+}
+
+/*
+ * @brief       :   Deletes the pointer to C-TKT-TKT cohort lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::cohortTktTkt_delete()
+{
+    for (int l = 0; l < numLocks; l++)
+    {
+        delete[] ctktlock[l].cohorts;
+    }
+    delete[] ctktlock;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initializes the pointer to timeout CLH lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::timeoutCLH_init()
+{
+    clhlock = new LockSlot<TimeoutCLH>[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        clhlock[l].tail.store(NULL, SEQ_CST);
+    }
+}
+
+/*
+ * @brief       :   Deletes the pointer to timeout CLH lock implementation
+ *
+ * @params      :   None
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::timeoutCLH_delete()
+{
+    for (int l = 0; l < numLocks; l++)
+    {
+        clhlock[l].cleanup();
+    }
+    delete[] clhlock;
 }
 /*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   Initialize lock
+ * @brief       :   Initialize numLocks instances of the lock, workloads other
+ *                  than LOCK_mode only use the first one
  *
  * @params      :   lock_algs_t 
  *                      alg     :   Locking algorithm to be used
  * 
  * @returns     :   None
  */
-static void lock_init(lock_algs_t alg)
+void CounterEngine::lock_init(lock_algs_t alg)
 {
     switch(locktype)
     {
@@ -235,6 +498,9 @@ static void lock_init(lock_algs_t alg)
         case PTHREAD_algorithm:         mutex_init(); break;
         case PETERSON_SEQ_algorithm:    petersonSeq_init(); break;
         case PETERSON_REL_algorithm:    petersonRel_init(); break;
+        case COHORT_BO_MCS_algorithm:   cohortBOMCS_init(); break;
+        case COHORT_TKT_TKT_algorithm:  cohortTktTkt_init(); break;
+        case TIMEOUT_CLH_algorithm:     timeoutCLH_init(); break;
         default:                        mutex_init(); break; 
     }
 }
@@ -246,7 +512,7 @@ static void lock_init(lock_algs_t alg)
  * 
  * @returns     :   None
  */
-static void lock_delete(lock_algs_t alg)
+void CounterEngine::lock_delete(lock_algs_t alg)
 {
     switch(locktype)
     {
@@ -257,10 +523,73 @@ static void lock_delete(lock_algs_t alg)
         case PTHREAD_algorithm:         mutex_delete(); break;
         case PETERSON_SEQ_algorithm:    petersonSeq_delete(); break;
         case PETERSON_REL_algorithm:    petersonRel_delete(); break;
+        case COHORT_BO_MCS_algorithm:   cohortBOMCS_delete(); break;
+        case COHORT_TKT_TKT_algorithm:  cohortTktTkt_delete(); break;
+        case TIMEOUT_CLH_algorithm:     timeoutCLH_delete(); break;
         default:                        mutex_delete(); break; 
     }
 }
 /*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initialize reader-writer lock
+ *
+ * @params      :   rwlock_types_t 
+ *                      rw          :   Reader-writer lock to be used
+ *                  size_t
+ *                      numThreads  :   Number of threads, one reader slot each
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::rwlock_init(rwlock_types_t rw, size_t numThreads)
+{
+    switch(rw)
+    {
+        case PHASEFAIR_RW_type:
+            pfrwlock = new PhaseFairRWLock;
+            pfrwlock->rin.store(0, SEQ_CST);
+            pfrwlock->rout.store(0, SEQ_CST);
+            pfrwlock->win.store(0, SEQ_CST);
+            pfrwlock->wout.store(0, SEQ_CST);
+        break;
+
+        case DIST_RW_type:
+            distrwlock = new DistRWLock;
+            distrwlock->writerlock.ttaslock.store(false, SEQ_CST);
+            distrwlock->writer.store(false, SEQ_CST);
+            distrwlock->numSlots = (int) numThreads;
+            distrwlock->slots = new ReaderSlot[numThreads];
+            for (size_t i = 0; i < numThreads; i++)
+            {
+                distrwlock->slots[i].active.store(false, SEQ_CST);
+            }
+        break;
+
+        case CENTRAL_RW_type:
+        default:
+            centralrwlock = new CentralRWLock;
+            centralrwlock->rwcount.store(0, SEQ_CST);
+        break;
+    }
+}
+/*
+ * @brief       :   Delete reader-writer lock
+ *
+ * @params      :   rwlock_types_t 
+ *                      rw          :   Reader-writer lock to be used
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::rwlock_delete(rwlock_types_t rw)
+{
+    switch(rw)
+    {
+        case PHASEFAIR_RW_type:         delete pfrwlock; break;
+        case DIST_RW_type:              delete[] distrwlock->slots; delete distrwlock; break;
+        case CENTRAL_RW_type:
+        default:                        delete centralrwlock; break;
+    }
+}
+/*---------------------------------------------------------------------------------*/
 /*
  * @brief       :   Initialize pthread barrier
  *
@@ -269,7 +598,7 @@ static void lock_delete(lock_algs_t alg)
  * 
  * @returns     :   None
  */
-static void pthread_barrier_init(size_t num_threads)
+void CounterEngine::pthread_barrier_init(size_t num_threads)
 {
     pthreadbar = new barrier(num_threads);
 }
@@ -281,7 +610,7 @@ static void pthread_barrier_init(size_t num_threads)
  * 
  * @returns     :   None
  */
-static void pthread_barrier_delete()
+void CounterEngine::pthread_barrier_delete()
 {
     delete pthreadbar;
 }
@@ -294,7 +623,7 @@ static void pthread_barrier_delete()
  * 
  * @returns     :   None
  */
-static void sense_barrier_init(size_t num_threads)
+void CounterEngine::sense_barrier_init(size_t num_threads)
 {
     sensebar = new Barrier;
     sensebar->count.store(0, SEQ_CST);
@@ -309,7 +638,7 @@ static void sense_barrier_init(size_t num_threads)
  * 
  * @returns     :   None
  */
-static void sense_barrier_delete()
+void CounterEngine::sense_barrier_delete()
 {
     delete sensebar;
 }
@@ -324,7 +653,7 @@ static void sense_barrier_delete()
  * 
  * @returns     :   None
  */
-static void barrier_init(size_t num_threads, barrier_types_t bar)
+void CounterEngine::barrier_init(size_t num_threads, barrier_types_t bar)
 {
     switch(bar)
     {
@@ -341,7 +670,7 @@ static void barrier_init(size_t num_threads, barrier_types_t bar)
  * 
  * @returns     :   None
  */
-static void barrier_delete(barrier_types_t bar)
+void CounterEngine::barrier_delete(barrier_types_t bar)
 {
     switch(bar)
     {
@@ -353,16 +682,81 @@ static void barrier_delete(barrier_types_t bar)
 
 /*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   Worker thread that increments counter variable using locks
+ * @brief       :   Sets the shape of LOCK_mode: number of locks and how they
+ *                  are picked, cache lines written under the lock, and the
+ *                  think time between two acquisitions
+ *
+ * @params      :   const counterConfig_t&
+ *                      config      :   settings of the run
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::workload_init(const counterConfig_t& config)
+{
+    numLocks = (config.mode == LOCK_mode) ? max(config.numLocks, 1) : 1;
+    csLines = max(config.csLines, 0);
+    thinkDist = config.think;
+    thinkNs = max(config.thinkNs, 0);
+    burst = max(config.burst, 1);
+
+    //lock l is picked with weight 1/(l+1)^zipf, lock 0 is the hottest
+    lockCdf.assign(numLocks, 0.0);
+    double sum = 0.0;
+    for (int l = 0; l < numLocks; l++)
+    {
+        sum += 1.0 / pow(l + 1, config.zipf);
+        lockCdf[l] = sum;
+    }
+    for (double& p : lockCdf)
+    {
+        p /= sum;
+    }
+
+    //every lock guards its own lines, so that no two locks write to one line
+    guarded.assign(numLocks * (csLines + 1), guardedLine_t{});
+}
+
+/*
+ * @brief       :   Busy-waits, models the work a thread does between two
+ *                  critical sections
+ *
+ * @params      :   unsigned long long
+ *                      ns          :   time to wait
+ * 
+ * @returns     :   None
+ */
+static void think_for(unsigned long long ns)
+{
+    struct timespec start, now;
+    getTime(&start);
+    do
+    {
+        cpu_relax();
+        getTime(&now);
+    } while (elapsed_ns(&start, &now) < ns);
+}
+
+/*
+ * @brief       :   Worker thread that increments counter variable using locks.
+ *                  Every iteration picks one of numLocks locks, increments its
+ *                  count and writes csLines more lines under it, then thinks
+ *                  once every burst iterations. With the defaults this is a
+ *                  single lock around one count with no think time, the
+ *                  counts are summed into ctr after the run
  *
  * @params      :   size_t
  *                      threadId    :   Unique id of thread
  * 
  * @returns     :   NULL
  */
-void *counter_lock(size_t threadId)
+void* CounterEngine::counter_lock(size_t threadId)
 {
     Node *thisNode = new Node; /*for MCS lock only*/
+    CLHNode *clhNode = NULL;    /*for timeout CLH lock, valid while the lock is held*/
+
+    pin_thread(threadId);       /*no-op unless --pin or --cpus was given*/
+    int myNode = topology_node_of_thread(threadId, num_threads);   /*for cohort locks*/
+    perf_thread_open();         /*open counters before the timed region*/
 
     //barrier wait here
     switch(bartype)
@@ -386,39 +780,91 @@ void *counter_lock(size_t threadId)
         default:                        pthreadbar->arrive_and_wait(); break;
     }
 
+    //count events only inside the timed region
+    perf_thread_start();
+
+    mt19937_64 rng(threadId);                   /*lock choice and think times of this thread*/
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    exponential_distribution<double> expo(1.0);
+    unsigned long long owed = 0;                /*think time of the current burst, in ns*/
+    guardedLine_t *data = guarded.data();       /*shape of the run, kept in registers*/
+    const int lines = csLines;
+    const int locks = numLocks;
+    const int thinkTime = thinkNs;
+
     /*increment counter*/
     for (int i = 0; i<numIterations; i++)
     {
+        //pick a lock, always lock 0 unless --num-locks was given
+        int l = 0;
+        if (locks > 1)
+        {
+            l = lower_bound(lockCdf.begin(), lockCdf.end(), unit(rng)) - lockCdf.begin();
+            l = min(l, locks - 1);
+        }
+
         //acquire lock
+        locktrace_begin(&lockTraces[l], threadId);     /*no-op unless --lock-trace was given*/
         switch(locktype)
         {
-            case TAS_algorithm:             taslock->TAS::TAS_lock(); break;
-            case TTAS_algorithm:            ttaslock->TTAS::TTAS_lock(); break;
-            case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_lock(); break;
-            case MCS_algorithm:             mcslock->MCS::acquire(thisNode); break;
-            case PTHREAD_algorithm:         mutexlock->lock(); break;
-            case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_lock(threadId); break;
-            case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_lock(threadId); break;
-            default:                        mutexlock->lock(); break;
+            case TAS_algorithm:             taslock[l].TAS::TAS_lock(); break;
+            case TTAS_algorithm:            ttaslock[l].TTAS::TTAS_lock(); break;
+            case TICKETLOCK_algorithm:      tktlock[l].TicketLock::Ticket_lock(); break;
+            case MCS_algorithm:             mcslock[l].MCS::acquire(thisNode); break;
+            case PTHREAD_algorithm:         mutexlock[l].lock(); break;
+            case PETERSON_SEQ_algorithm:    petersonseqlock[l].Peterson::sequential_lock(threadId); break;
+            case PETERSON_REL_algorithm:    petersonrellock[l].Peterson::released_lock(threadId); break;
+            case COHORT_BO_MCS_algorithm:   cbomcslock[l].CohortBOMCS::acquire(myNode, thisNode); break;
+            case COHORT_TKT_TKT_algorithm:  ctktlock[l].CohortTktTkt::acquire(myNode); break;
+            case TIMEOUT_CLH_algorithm:     clhNode = clhlock[l].TimeoutCLH::acquire(); break;
+            default:                        mutexlock[l].lock(); break;
         }
+        locktrace_acquired(&lockTraces[l], threadId);
 
-        //update counter
-        ctr++;
+        //update counter of the lock, and the other lines it guards
+        guardedLine_t *mine = &data[l * (lines + 1)];
+        mine[0].word[0]++;
+        for (int k = 1; k <= lines; k++)
+        {
+            mine[k].word[0]++;
+        }
 
         //release the lock
+        locktrace_release(&lockTraces[l], threadId);
         switch(locktype)
         {
-            case TAS_algorithm:             taslock->TAS::TAS_unlock(); break;
-            case TTAS_algorithm:            ttaslock->TTAS::TTAS_unlock(); break;
-            case TICKETLOCK_algorithm:      tktlock->TicketLock::Ticket_unlock(); break;
-            case MCS_algorithm:             mcslock->MCS::release(thisNode); break;
-            case PTHREAD_algorithm:         mutexlock->unlock(); break;
-            case PETERSON_SEQ_algorithm:    petersonseqlock->Peterson::sequential_unlock(threadId); break;
-            case PETERSON_REL_algorithm:    petersonrellock->Peterson::released_unlock(threadId); break;
-            default:                        mutexlock->unlock(); break;
+            case TAS_algorithm:             taslock[l].TAS::TAS_unlock(); break;
+            case TTAS_algorithm:            ttaslock[l].TTAS::TTAS_unlock(); break;
+            case TICKETLOCK_algorithm:      tktlock[l].TicketLock::Ticket_unlock(); break;
+            case MCS_algorithm:             mcslock[l].MCS::release(thisNode); break;
+            case PTHREAD_algorithm:         mutexlock[l].unlock(); break;
+            case PETERSON_SEQ_algorithm:    petersonseqlock[l].Peterson::sequential_unlock(threadId); break;
+            case PETERSON_REL_algorithm:    petersonrellock[l].Peterson::released_unlock(threadId); break;
+            case COHORT_BO_MCS_algorithm:   cbomcslock[l].CohortBOMCS::release(myNode, thisNode); break;
+            case COHORT_TKT_TKT_algorithm:  ctktlock[l].CohortTktTkt::release(myNode); break;
+            case TIMEOUT_CLH_algorithm:     clhlock[l].TimeoutCLH::release(clhNode); break;
+            default:                        mutexlock[l].unlock(); break;
+        }
+
+        //think, for the whole burst once it is complete
+        if (thinkTime > 0)
+        {
+            switch(thinkDist)
+            {
+                case UNIFORM_think:         owed += (unsigned long long)(unit(rng) * 2.0 * thinkTime); break;
+                case EXP_think:             owed += (unsigned long long)(expo(rng) * thinkTime); break;
+                default:                    owed += thinkTime; break;
+            }
+            if ((i + 1) % burst == 0)
+            {
+                think_for(owed);
+                owed = 0;
+            }
         }
     }
 
+    perf_thread_stop(threadId);
+
     //barrier wait here
     switch(bartype)
     {
@@ -455,9 +901,11 @@ void *counter_lock(size_t threadId)
  * 
  * @returns     :   NULL
  */
-void *counter_barrier(size_t threadId)
+void* CounterEngine::counter_barrier(size_t threadId)
 {
-    
+    pin_thread(threadId);       /*no-op unless --pin or --cpus was given*/
+    perf_thread_open();         /*open counters before the timed region*/
+
     //barrier wait here
     switch(bartype)
     {
@@ -480,6 +928,9 @@ void *counter_barrier(size_t threadId)
         default:                        pthreadbar->arrive_and_wait(); break;
     }
 
+    //count events only inside the timed region
+    perf_thread_start();
+
     threadId--; // adjust to zero based tid's
 
     /*increment counter*/
@@ -511,6 +962,8 @@ void *counter_barrier(size_t threadId)
 
     threadId++; //restore original thread id's
 
+    perf_thread_stop(threadId);
+
     //barrier wait here
     switch(bartype)
     {
@@ -536,68 +989,852 @@ void *counter_barrier(size_t threadId)
     /*work done, return*/
     return NULL; 
 }
-/*---------------------------------------------------------------------------------*/\
+/*---------------------------------------------------------------------------------*/
 /*
- * @brief       :   Worker thread that increments counter variable using barrier
+ * @brief       :   Worker thread that reads or increments counter variable using
+ *                  a reader-writer lock. Iteration i is a read if (i % 100) is
+ *                  below readPercent, so the final count is deterministic
  *
- * @params      :   lock_algs_t
- *                      alg         :   Locking algorithm to be used
- *                  barrier_types_t
- *                      bar         :   Barrier to be used
- *                  bool
- *                      barFlag     :   whether to use barrier implementation or not
- *                  int 
- *                      num         :   Number of iterations
- *                  size_t
- *                      numThreads  :   Number of threads to be used
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread
  * 
- * @returns     :   int
- *                      final count updated by all threads
+ * @returns     :   NULL
  */
-int counter(lock_algs_t alg, barrier_types_t bar, bool barFlag, int num, size_t numThreads)
+void* CounterEngine::counter_rwlock(size_t threadId)
 {
-    locktype = alg;             /*update lock type*/
-    bartype = bar;              /*update barrier type*/
-    numIterations = num;        /*update number of iterations*/
-    num_threads = numThreads;   /*update number of threads*/
-    threads.resize(numThreads); /*resize the threads vector*/
+    volatile int seen = 0;      /*keeps reads from being optimized away*/
+    int slot = threadId - 1;    /*reader slot for distributed lock*/
 
-    lock_init(alg);             /*initialize lock*/
-    barrier_init(numThreads, bar);  /*initialize barrier*/
-    
-    if (barFlag == true)
+    pin_thread(threadId);       /*no-op unless --pin or --cpus was given*/
+    perf_thread_open();         /*open counters before the timed region*/
+
+    //barrier wait here
+    switch(bartype)
     {
-        //we will increment counter using barrier synchronization
-        for(size_t i=1; i<numThreads; i++)
-        {
-            threads[i] = new thread(counter_barrier, i+1);
-        }
-        //master thread will also perform
-        counter_barrier(1);
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
     }
-    else
+
+    //main thread records start time here
+    if (threadId == 1)
     {
-        //we will increment counter using locks
-        for(size_t i=1; i<numThreads; i++)
+        getTime(&startTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //count events only inside the timed region
+    perf_thread_start();
+
+    for (int i = 0; i<numIterations; i++)
+    {
+        if ((i % 100) < readPercent)
+        {
+            //read the counter
+            switch(rwtype)
+            {
+                case PHASEFAIR_RW_type:     pfrwlock->PhaseFairRWLock::read_lock(); break;
+                case DIST_RW_type:          distrwlock->DistRWLock::read_lock(slot); break;
+                default:                    centralrwlock->CentralRWLock::read_lock(); break;
+            }
+
+            seen = ctr;
+
+            switch(rwtype)
+            {
+                case PHASEFAIR_RW_type:     pfrwlock->PhaseFairRWLock::read_unlock(); break;
+                case DIST_RW_type:          distrwlock->DistRWLock::read_unlock(slot); break;
+                default:                    centralrwlock->CentralRWLock::read_unlock(); break;
+            }
+        }
+        else
         {
-            threads[i] = new thread(counter_lock, i+1);
+            //update counter
+            switch(rwtype)
+            {
+                case PHASEFAIR_RW_type:     pfrwlock->PhaseFairRWLock::write_lock(); break;
+                case DIST_RW_type:          distrwlock->DistRWLock::write_lock(); break;
+                default:                    centralrwlock->CentralRWLock::write_lock(); break;
+            }
+
+            ctr++;
+
+            switch(rwtype)
+            {
+                case PHASEFAIR_RW_type:     pfrwlock->PhaseFairRWLock::write_unlock(); break;
+                case DIST_RW_type:          distrwlock->DistRWLock::write_unlock(); break;
+                default:                    centralrwlock->CentralRWLock::write_unlock(); break;
+            }
         }
-        //master thread will also perform
-        counter_lock(1);
     }
+    (void)seen;
 
-    //wait for threads to complete their execution and join them together
-    for(size_t i=1; i<numThreads; i++)
+    perf_thread_stop(threadId);
+
+    //barrier wait here
+    switch(bartype)
     {
-        threads[i]->join();
-        delete threads[i];
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
     }
-    
-    lock_delete(alg);           /*delete lock*/
-    barrier_delete(bar);        /*delete barrier*/
 
-    //counter value should be (numThreads*numIterations)
-    return ctr;                 /*return updated count*/
+    //main thread records stop time here
+    if (threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    /*work done, return*/
+    return NULL; 
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initialize the statistic of STATS_mode and its guard
+ *
+ * @params      :   stats_guards_t 
+ *                      guard   :   guard to be used
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::stats_init(stats_guards_t guard)
+{
+    stats.count.store(0, SEQ_CST);
+    stats.sum.store(0, SEQ_CST);
+    stats.min.store(LONG_MAX, SEQ_CST);
+    stats.max.store(LONG_MIN, SEQ_CST);
+    snapshotsTaken.store(0, SEQ_CST);
+    snapshotsTorn.store(0, SEQ_CST);
+
+    switch(guard)
+    {
+        case MUTEX_guard:
+            statsmutex = new mutex;
+        break;
+
+        case SEQLOCK_guard:
+        default:
+            seqlock = new SeqLock;
+            seqlock->seq.store(0, SEQ_CST);
+        break;
+    }
+}
+
+/*
+ * @brief       :   Delete the guard of the statistic of STATS_mode
+ *
+ * @params      :   stats_guards_t 
+ *                      guard   :   guard to be used
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::stats_delete(stats_guards_t guard)
+{
+    switch(guard)
+    {
+        case MUTEX_guard:               delete statsmutex; break;
+        case SEQLOCK_guard:
+        default:                        delete seqlock; break;
+    }
+}
+
+/*
+ * @brief       :   Worker thread of STATS_mode. The first numWriters threads add
+ *                  every iteration number to the statistic, the other threads
+ *                  take a snapshot every iteration and check it is consistent
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread
+ * 
+ * @returns     :   NULL
+ */
+void* CounterEngine::counter_stats(size_t threadId)
+{
+    bool writer = ((int)threadId <= numWriters);
+    long taken = 0, torn = 0;
+
+    pin_thread(threadId);       /*no-op unless --pin or --cpus was given*/
+    perf_thread_open();         /*open counters before the timed region*/
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //main thread records start time here
+    if (threadId == 1)
+    {
+        getTime(&startTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //count events only inside the timed region
+    perf_thread_start();
+
+    for (int i = 0; i<numIterations; i++)
+    {
+        if (writer)
+        {
+            switch(statsguard)
+            {
+                case MUTEX_guard:       statsmutex->lock(); break;
+                default:                seqlock->SeqLock::write_lock(); break;
+            }
+
+            stats.count.store(stats.count.load(RELAXED) + 1, RELAXED);
+            stats.sum.store(stats.sum.load(RELAXED) + i, RELAXED);
+            if (i < stats.min.load(RELAXED))
+            {
+                stats.min.store(i, RELAXED);
+            }
+            if (i > stats.max.load(RELAXED))
+            {
+                stats.max.store(i, RELAXED);
+            }
+
+            switch(statsguard)
+            {
+                case MUTEX_guard:       statsmutex->unlock(); break;
+                default:                seqlock->SeqLock::write_unlock(); break;
+            }
+        }
+        else
+        {
+            long count, sum, min, max;
+            if (statsguard == MUTEX_guard)
+            {
+                statsmutex->lock();
+                count = stats.count.load(RELAXED);
+                sum = stats.sum.load(RELAXED);
+                min = stats.min.load(RELAXED);
+                max = stats.max.load(RELAXED);
+                statsmutex->unlock();
+            }
+            else
+            {
+                unsigned int seq;
+                do
+                {
+                    seq = seqlock->SeqLock::read_begin();
+                    count = stats.count.load(RELAXED);
+                    sum = stats.sum.load(RELAXED);
+                    min = stats.min.load(RELAXED);
+                    max = stats.max.load(RELAXED);
+                } while(seqlock->SeqLock::read_retry(seq));
+            }
+
+            //every value added lies in [min, max]
+            taken++;
+            if ((count > 0) && ((min > max) || (sum < min*count) || (sum > max*count)))
+            {
+                torn++;
+            }
+        }
+    }
+
+    perf_thread_stop(threadId);
+
+    snapshotsTaken.fetch_add(taken, SEQ_CST);
+    snapshotsTorn.fetch_add(torn, SEQ_CST);
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //main thread records stop time here
+    if (threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    /*work done, return*/
+    return NULL; 
+}
+
+/*
+ * @brief       :   prints snapshots read in STATS_mode and how many of them
+ *                  were inconsistent
+ *
+ * @params      :   const counterResult_t&
+ *                      result  :   result of a STATS_mode run
+ * 
+ * @returns     :   None
+ */
+void printStatsSummary(const counterResult_t& result)
+{
+    printf("Snapshots: %ld, inconsistent: %ld\n", result.snapshotsTaken, result.snapshotsTorn);
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   Initialize the bounded buffer of PIPE_mode and its blocking
+ *                  primitives
+ *
+ * @params      :   pipe_types_t 
+ *                      pipe        :   blocking primitive to be used
+ *                  int
+ *                      producers   :   number of producer threads
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::pipe_init(pipe_types_t pipe, int producers)
+{
+    pipeHead = 0;
+    pipeTail = 0;
+    pipeCount = 0;
+    producersLeft.store(producers, SEQ_CST);
+
+    switch(pipe)
+    {
+        case SEMAPHORE_pipe:
+            slotsSem = new Semaphore;
+            slotsSem->count.store(PIPE_DEPTH, SEQ_CST);
+            slotsSem->waiters.store(0, SEQ_CST);
+            itemsSem = new Semaphore;
+            itemsSem->count.store(0, SEQ_CST);
+            itemsSem->waiters.store(0, SEQ_CST);
+        break;
+
+        case CONDVAR_pipe:
+        default:
+            notFull = new CondVar;
+            notFull->seq.store(0, SEQ_CST);
+            notFull->waiters.store(0, SEQ_CST);
+            notEmpty = new CondVar;
+            notEmpty->seq.store(0, SEQ_CST);
+            notEmpty->waiters.store(0, SEQ_CST);
+        break;
+    }
+}
+
+/*
+ * @brief       :   Delete the blocking primitives of PIPE_mode
+ *
+ * @params      :   pipe_types_t 
+ *                      pipe    :   blocking primitive to be used
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::pipe_delete(pipe_types_t pipe)
+{
+    switch(pipe)
+    {
+        case SEMAPHORE_pipe:            delete slotsSem; delete itemsSem; break;
+        case CONDVAR_pipe:
+        default:                        delete notFull; delete notEmpty; break;
+    }
+}
+
+/*
+ * @brief       :   Appends an item to the bounded buffer, waits while it is full
+ *
+ * @params      :   L&
+ *                      lock    :   lock guarding the buffer
+ *                  int
+ *                      item    :   item to be appended
+ * 
+ * @returns     :   None
+ */
+template <class L>
+void CounterEngine::pipe_put(L& lock, int item)
+{
+    if (pipetype == SEMAPHORE_pipe)
+    {
+        slotsSem->Semaphore::wait();
+        lock.lock();
+    }
+    else
+    {
+        lock.lock();
+        notFull->CondVar::wait(lock, [this]{ return pipeCount < PIPE_DEPTH; });
+    }
+
+    pipeRing[pipeTail] = item;
+    pipeTail = (pipeTail + 1) % PIPE_DEPTH;
+    pipeCount++;
+
+    //wake the other side after unlocking, so that it does not spin on our lock
+    lock.unlock();
+    if (pipetype == SEMAPHORE_pipe)
+    {
+        itemsSem->Semaphore::post();
+    }
+    else
+    {
+        notEmpty->CondVar::notify_one();
+    }
+}
+
+/*
+ * @brief       :   Takes an item from the bounded buffer and adds it to the
+ *                  counter, waits while the buffer is empty
+ *
+ * @params      :   L&
+ *                      lock    :   lock guarding the buffer
+ * 
+ * @returns     :   int
+ *                      item taken, 0 marks the end of the stream
+ */
+template <class L>
+int CounterEngine::pipe_get(L& lock)
+{
+    if (pipetype == SEMAPHORE_pipe)
+    {
+        itemsSem->Semaphore::wait();
+        lock.lock();
+    }
+    else
+    {
+        lock.lock();
+        notEmpty->CondVar::wait(lock, [this]{ return pipeCount > 0; });
+    }
+
+    int item = pipeRing[pipeHead];
+    pipeHead = (pipeHead + 1) % PIPE_DEPTH;
+    pipeCount--;
+    ctr += item;
+
+    //wake the other side after unlocking, so that it does not spin on our lock
+    lock.unlock();
+    if (pipetype == SEMAPHORE_pipe)
+    {
+        slotsSem->Semaphore::post();
+    }
+    else
+    {
+        notFull->CondVar::notify_one();
+    }
+    return item;
+}
+
+/*
+ * @brief       :   Appends an item to the bounded buffer using selected lock
+ *
+ * @params      :   int
+ *                      item    :   item to be appended
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::pipe_put_item(int item)
+{
+    switch(locktype)
+    {
+        case TAS_algorithm:             pipe_put(*taslock, item); break;
+        case TTAS_algorithm:            pipe_put(*ttaslock, item); break;
+        case TICKETLOCK_algorithm:      pipe_put(*tktlock, item); break;
+        case MCS_algorithm:             pipe_put(*mcslock, item); break;
+        case TIMEOUT_CLH_algorithm:     pipe_put(*clhlock, item); break;
+        case PTHREAD_algorithm:
+        default:                        pipe_put(*mutexlock, item); break;
+    }
+}
+
+/*
+ * @brief       :   Takes an item from the bounded buffer using selected lock
+ *
+ * @params      :   None
+ * 
+ * @returns     :   int
+ *                      item taken, 0 marks the end of the stream
+ */
+int CounterEngine::pipe_get_item()
+{
+    switch(locktype)
+    {
+        case TAS_algorithm:             return pipe_get(*taslock);
+        case TTAS_algorithm:            return pipe_get(*ttaslock);
+        case TICKETLOCK_algorithm:      return pipe_get(*tktlock);
+        case MCS_algorithm:             return pipe_get(*mcslock);
+        case TIMEOUT_CLH_algorithm:     return pipe_get(*clhlock);
+        case PTHREAD_algorithm:
+        default:                        return pipe_get(*mutexlock);
+    }
+}
+
+/*
+ * @brief       :   Worker thread of PIPE_mode. The first numProducers threads
+ *                  put numIterations items each into the bounded buffer, the
+ *                  last producer to finish puts one end marker per consumer.
+ *                  The other threads take items and add them to the counter
+ *                  until they take an end marker
+ *
+ * @params      :   size_t
+ *                      threadId    :   Unique id of thread
+ * 
+ * @returns     :   NULL
+ */
+void* CounterEngine::counter_pipe(size_t threadId)
+{
+    bool producer = ((int)threadId <= numProducers);
+
+    pin_thread(threadId);       /*no-op unless --pin or --cpus was given*/
+    perf_thread_open();         /*open counters before the timed region*/
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //main thread records start time here
+    if (threadId == 1)
+    {
+        getTime(&startTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //count events only inside the timed region
+    perf_thread_start();
+
+    if (producer)
+    {
+        for (int i = 0; i<numIterations; i++)
+        {
+            pipe_put_item(1);
+        }
+
+        //last producer tells every consumer to stop
+        if (producersLeft.fetch_sub(1, SEQ_CST) == 1)
+        {
+            for (int c = numProducers; c < num_threads; c++)
+            {
+                pipe_put_item(0);
+            }
+        }
+    }
+    else
+    {
+        while (pipe_get_item() != 0)
+        {
+            //item was added to the counter under the lock
+        }
+    }
+
+    perf_thread_stop(threadId);
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    //main thread records stop time here
+    if (threadId == 1)
+    {
+        getTime(&endTime);
+    }
+
+    //barrier wait here
+    switch(bartype)
+    {
+        case PTHREAD_type:              pthreadbar->arrive_and_wait(); break;
+        case SENSE_REV_type:            sensebar->Barrier::wait(); break;
+        default:                        pthreadbar->arrive_and_wait(); break;
+    }
+
+    /*work done, return*/
+    return NULL; 
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   runs a job on the pool of this counter, the pool is created
+ *                  on first use and replaced by a bigger one if needed
+ *
+ * @params      :   pool_job_t
+ *                      fn          :   job to be run, captures this counter
+ *                  size_t
+ *                      numThreads  :   threads taking part, including the caller
+ * 
+ * @returns     :   None
+ */
+void CounterEngine::pool_run(pool_job_t fn, size_t numThreads)
+{
+    if (pool == NULL || pool->numThreads < numThreads)
+    {
+        pool_destroy(pool);
+        pool = pool_create(numThreads);
+    }
+    pool->run(fn, numThreads);
+}
+
+/*
+ * @brief       :   Runs the selected workload on the thread pool, the calling
+ *                  thread takes part as thread 1. Every run starts from a zero
+ *                  counter and fresh locks, barriers and buffers
+ *
+ * @params      :   const counterConfig_t&
+ *                      config      :   workload, lock, barrier and sizes of the run
+ * 
+ * @returns     :   counterResult_t
+ *                      final count, expected count and timed region of the run
+ */
+counterResult_t CounterEngine::run(const counterConfig_t& config)
+{
+    counter_modes_t mode = config.mode;
+    lock_algs_t alg = config.lock;
+    barrier_types_t bar = config.bar;
+    size_t numThreads = max(config.numThreads, (size_t)1);
+
+    ctr = 0;                    /*counter may be run more than once per process*/
+    locktype = alg;             /*update lock type*/
+    bartype = bar;              /*update barrier type*/
+    rwtype = config.rw;
+    readPercent = config.readPercent;
+    statsguard = config.statsguard;
+    numWriters = config.numWriters;
+    pipetype = config.pipe;
+    numProducers = config.numProducers;
+    numIterations = config.numIterations;   /*update number of iterations*/
+
+    //peterson's locks only support two threads
+    if (alg == PETERSON_SEQ_algorithm || alg == PETERSON_REL_algorithm)
+    {
+        numThreads = min(numThreads, (size_t)2);
+    }
+
+    if (mode == PIPE_mode)
+    {
+        //the buffer needs at least one producer and one consumer
+        if (numThreads < 2)
+        {
+            cout << "Pipeline needs at least 2 threads, using 2" << endl;
+            numThreads = 2;
+        }
+        if (numProducers <= 0 || numProducers >= (int)numThreads)
+        {
+            numProducers = numThreads / 2;
+        }
+        //condition variables need lock() & unlock(), other locks fall back to mutex
+        switch(alg)
+        {
+            case TAS_algorithm:
+            case TTAS_algorithm:
+            case TICKETLOCK_algorithm:
+            case MCS_algorithm:
+            case TIMEOUT_CLH_algorithm:
+            case PTHREAD_algorithm:
+            break;
+            default:
+                cout << "Selected lock cannot guard the pipeline, using pthread" << endl;
+                locktype = alg = PTHREAD_algorithm;
+            break;
+        }
+    }
+    num_threads = numThreads;   /*update number of threads*/
+
+    workload_init(config);      /*number of locks, critical section and think time*/
+    lock_init(alg);             /*initialize lock*/
+    barrier_init(numThreads, bar);  /*initialize barrier*/
+    perf_init(numThreads);          /*allocate per-thread counter samples*/
+    locktrace_init(numThreads);     /*make room for per-thread lock trace rings*/
+    lockTraces = new lockTrace_t[numLocks];
+    for (int l = 0; l < numLocks; l++)
+    {
+        locktrace_register(&lockTraces[l], alg, l);
+    }
+    
+    if (mode == RWLOCK_mode)
+    {
+        rwlock_init(rwtype, numThreads);
+        //readers and writers share the counter through a reader-writer lock
+        pool_run([this](size_t threadId) { return counter_rwlock(threadId); }, numThreads);
+    }
+    else if (mode == STATS_mode)
+    {
+        stats_init(statsguard);
+        //few writers update the statistic, the rest read it
+        pool_run([this](size_t threadId) { return counter_stats(threadId); }, numThreads);
+        ctr = stats.count.load(SEQ_CST);
+    }
+    else if (mode == PIPE_mode)
+    {
+        pipe_init(pipetype, numProducers);
+        //producers pass items to consumers, which add them to the counter
+        pool_run([this](size_t threadId) { return counter_pipe(threadId); }, numThreads);
+    }
+    else if (mode == BARRIER_mode)
+    {
+        //we will increment counter using barrier synchronization
+        pool_run([this](size_t threadId) { return counter_barrier(threadId); }, numThreads);
+    }
+    else
+    {
+        //we will increment counter using locks
+        pool_run([this](size_t threadId) { return counter_lock(threadId); }, numThreads);
+
+        //every lock counted its own increments
+        long count = 0;
+        for (int l = 0; l < numLocks; l++)
+        {
+            count += guarded[l * (csLines + 1)].word[0];
+        }
+        ctr = (int)count;
+    }
+
+    lock_delete(alg);           /*delete lock*/
+    delete[] lockTraces;
+    barrier_delete(bar);        /*delete barrier*/
+    if (mode == RWLOCK_mode)
+    {
+        rwlock_delete(rwtype);  /*delete reader-writer lock*/
+    }
+    if (mode == STATS_mode)
+    {
+        stats_delete(statsguard);   /*delete guard of the statistic*/
+    }
+    if (mode == PIPE_mode)
+    {
+        pipe_delete(pipetype);  /*delete blocking primitives of the buffer*/
+    }
+
+    counterResult_t result;
+    result.count = ctr;
+    result.lock = alg;
+    result.numThreads = numThreads;
+    result.numProducers = (mode == PIPE_mode) ? numProducers : 0;
+    result.startTime = startTime;
+    result.endTime = endTime;
+    result.elapsedNs = elapsed_ns(&startTime, &endTime);
+    result.snapshotsTaken = (mode == STATS_mode) ? snapshotsTaken.load(SEQ_CST) : 0;
+    result.snapshotsTorn = (mode == STATS_mode) ? snapshotsTorn.load(SEQ_CST) : 0;
+
+    //counter value should be (numThreads*numIterations), or number of writes in RWLOCK_mode & STATS_mode,
+    //or (numProducers*numIterations) in PIPE_mode
+    long perThread = numIterations;
+    if (mode == RWLOCK_mode)
+    {
+        //iteration i writes if (i % 100) is not below readPercent
+        perThread = 0;
+        for (int i = 0; i < numIterations; i++)
+        {
+            perThread += ((i % 100) >= readPercent);
+        }
+        result.expected = perThread * numThreads;
+    }
+    else if (mode == STATS_mode)
+    {
+        result.expected = perThread * min((long)max(numWriters, 0), (long)numThreads);
+    }
+    else if (mode == PIPE_mode)
+    {
+        result.expected = perThread * numProducers;
+    }
+    else
+    {
+        result.expected = perThread * numThreads;
+    }
+    return result;
+}
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   creates a counter with its own locks, barriers, buffers and
+ *                  thread pool. The workers are started by the first run
+ *
+ * @params      :   const counterConfig_t&
+ *                      config      :   settings of the runs, may be changed
+ *                                      between runs
+ * 
+ * @returns     :   Counter*
+ *                      new counter, deleted with counter_delete()
+ */
+Counter* counter_init(const counterConfig_t& config)
+{
+    Counter *c = new Counter;
+    c->config = config;
+    c->impl = new CounterEngine;
+    c->impl->pool = NULL;
+    return c;
+}
+
+/*
+ * @brief       :   stops the workers of a counter and deletes it
+ *
+ * @params      :   Counter
+ *                      *c          :   counter to be deleted, may be NULL
+ * 
+ * @returns     :   None
+ */
+void counter_delete(Counter *c)
+{
+    if (c == NULL)
+    {
+        return;
+    }
+    pool_destroy(c->impl->pool);
+    delete c->impl;
+    delete c;
+}
+
+/*perf counters and lock traces are tables of the process, held by a run
+  which records any of them*/
+static mutex diagBusy;
+
+/*
+ * @brief       :   runs the workload selected in config. Runs of one counter are
+ *                  serialized, runs of different counters happen at the same time
+ *                  unless --perf or --lock-trace is on
+ *
+ * @params      :   None
+ * 
+ * @returns     :   counterResult_t
+ *                      final count, expected count and timed region of the run
+ */
+counterResult_t Counter::run()
+{
+    lock_guard<mutex> guard(busy);
+    unique_lock<mutex> diagGuard(diagBusy, defer_lock);
+    if (perfFlag || lockTraceFlag)
+    {
+        diagGuard.lock();
+    }
+    return impl->run(config);
 }
 /*---------------------------------------------------------------------------------*/
-/*EOF*/
\ No newline at end of file
+/*EOF*/
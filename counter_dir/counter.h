@@ -16,9 +16,107 @@
 #include <atomic>
 #include <fstream>
 #include <barrier>
+#include <climits>
+#include <random>
+#include <cmath>
+#include <algorithm>
 
 #include "locks.h"
 
-int counter(lock_algs_t alg, barrier_types_t bar, bool barFlag, int num, size_t numThreads);
+/*ENUMERATED LIST OF ALL AVAILABLE COUNTER WORKLOADS*/
+typedef enum counter_modes
+{
+    LOCK_mode = 0,      /*every thread increments the counter under a lock*/
+    BARRIER_mode,       /*threads take turns incrementing, separated by barriers*/
+    RWLOCK_mode,        /*threads read or increment the counter under a reader-writer lock*/
+    STATS_mode,         /*few threads update a multi-field statistic, the rest take snapshots*/
+    PIPE_mode           /*producers pass items to consumers through a bounded buffer*/
+}counter_modes_t;
+
+/*ENUMERATED LIST OF ALL AVAILABLE GUARDS FOR THE STATISTIC OF STATS_mode*/
+typedef enum stats_guards
+{
+    SEQLOCK_guard = 0,
+    MUTEX_guard
+}stats_guards_t;
+
+/*ENUMERATED LIST OF ALL AVAILABLE WAYS TO BLOCK ON THE BUFFER OF PIPE_mode*/
+typedef enum pipe_types
+{
+    CONDVAR_pipe = 0,   /*selected lock with two condition variables*/
+    SEMAPHORE_pipe      /*selected lock with two counting semaphores*/
+}pipe_types_t;
+
+/*ENUMERATED LIST OF ALL AVAILABLE THINK TIME DISTRIBUTIONS OF LOCK_mode*/
+typedef enum think_dists
+{
+    CONST_think = 0,    /*every think time is the mean*/
+    UNIFORM_think,      /*uniform in [0, 2*mean]*/
+    EXP_think           /*exponential, i.e. Poisson arrivals*/
+}think_dists_t;
+
+#define DEFAULT_READ_PERCENT    (90)    /*share of reads in RWLOCK_mode*/
+#define DEFAULT_NUM_WRITERS     (1)     /*threads updating the statistic in STATS_mode*/
+#define PIPE_DEPTH              (64)    /*slots of the bounded buffer in PIPE_mode*/
+
+/*settings of one run, the defaults are those of the command line*/
+typedef struct counterConfig
+{
+    counter_modes_t mode = LOCK_mode;           /*workload, selected by --bar, --rw, --stats or --pipe*/
+    lock_algs_t lock = PTHREAD_algorithm;       /*--lock*/
+    barrier_types_t bar = PTHREAD_type;         /*--bar, also synchronizes the timed region*/
+    rwlock_types_t rw = CENTRAL_RW_type;        /*--rw, reader-writer lock of RWLOCK_mode*/
+    int readPercent = DEFAULT_READ_PERCENT;     /*--read-pct, iterations that only read the counter*/
+    stats_guards_t statsguard = SEQLOCK_guard;  /*--stats, guard of the statistic in STATS_mode*/
+    int numWriters = DEFAULT_NUM_WRITERS;       /*--writers, threads updating the statistic*/
+    pipe_types_t pipe = CONDVAR_pipe;           /*--pipe, blocking primitive of the buffer in PIPE_mode*/
+    int numProducers = 0;                       /*--producers, 0 for half of the threads*/
+    int numLocks = 1;                           /*--num-locks, locks of LOCK_mode, one is picked per iteration*/
+    double zipf = 0.0;                          /*--zipf, skew of the lock choice, 0 for uniform*/
+    int csLines = 0;                            /*--cs-lines, cache lines written in every critical section*/
+    think_dists_t think = CONST_think;          /*--think, distribution of the time between two acquisitions*/
+    int thinkNs = 0;                            /*--think-ns, mean think time, 0 for none*/
+    int burst = 1;                              /*--burst, acquisitions made back-to-back before thinking for all of them*/
+    int numIterations = 0;                      /*-i, iterations of every thread*/
+    size_t numThreads = 1;                      /*-t, threads of every run including the caller*/
+}counterConfig_t;
+
+/*outcome of one run*/
+typedef struct counterResult
+{
+    int count;                                  /*final value of the counter*/
+    long expected;                              /*value the counter must reach*/
+    lock_algs_t lock;                           /*lock used, PIPE_mode may fall back to pthread*/
+    size_t numThreads;                          /*threads used, after clamping*/
+    int numProducers;                           /*producer threads used in PIPE_mode*/
+    struct timespec startTime, endTime;         /*timed region*/
+    unsigned long long elapsedNs;               /*length of the timed region*/
+    long snapshotsTaken;                        /*snapshots read in STATS_mode*/
+    long snapshotsTorn;                         /*snapshots which were not consistent*/
+}counterResult_t;
+
+/*---------------------------------------------------------------------------------*/
+class CounterEngine;    /*counter, locks, barriers and thread pool of a counter, defined in counter.cpp*/
+
+/*Counter class definition. A counter owns all state of its runs, so that many
+  configurations can be run back-to-back in one process. Runs of one counter
+  are serialized. --perf and --lock-trace record into tables of the process and
+  are meant for the command line: while one of them is on, runs of all counters
+  happen one at a time*/
+class Counter
+{
+    public:
+        counterConfig_t config;                 /*settings of the next run*/
+        CounterEngine *impl;                    /*state of the runs*/
+        std::mutex busy;                        /*held while a run is in progress*/
+
+        counterResult_t run();  //defined in counter.cpp
+};
+
+Counter* counter_init(const counterConfig_t& config);
+
+void counter_delete(Counter *c);
+
+void printStatsSummary(const counterResult_t& result);
 
 #endif /*_COUNTER_H_*/
\ No newline at end of file
@@ -15,11 +15,30 @@
 #include <thread>
 #include <vector>
 #include <cstdbool>
+#include <chrono>
 
 /*GLOBAL DEFINES*/
 #define SEQ_CST (std::memory_order_seq_cst)     /*sequential consistency*/
 #define RELEASE (std::memory_order_acq_rel)     /*release consistency*/
 #define RELAXED (std::memory_order_relaxed)     /*relaxed consistency*/
+#define ACQUIRE (std::memory_order_acquire)     /*acquire ordering, for loads*/
+#define RELEASE_STORE (std::memory_order_release)   /*release ordering, for stores*/
+
+#define CACHE_LINE_SIZE             (64)        /*used to pad per-node and per-thread state*/
+#define COHORT_DEFAULT_PASS_BOUND   (64)        /*local handoffs before the global lock is released*/
+#define BACKOFF_MIN                 (4)         /*initial backoff of backoff lock, in pause instructions*/
+#define BACKOFF_MAX                 (1024)      /*maximum backoff of backoff lock, in pause instructions*/
+#define SPIN_BEFORE_BLOCK           (128)       /*polls of condition variable & semaphore before sleeping*/
+
+/*hint to the cpu that we are spinning*/
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
 
 /*ENUMERATED LIST OF ALL AVAILABLE LOCKING ALGORITHMS*/
 typedef enum locking_algorithms
@@ -31,7 +50,10 @@ typedef enum locking_algorithms
     MCS_algorithm = 3,
     PTHREAD_algorithm = 4,
     PETERSON_SEQ_algorithm = 5,
-    PETERSON_REL_algorithm = 6   
+    PETERSON_REL_algorithm = 6,
+    COHORT_BO_MCS_algorithm = 7,
+    COHORT_TKT_TKT_algorithm = 8,
+    TIMEOUT_CLH_algorithm = 9
 }lock_algs_t;
 
 /*ENUMERATED LIST OF ALL AVAILABLE BARRIER ALGORITHMS*/
@@ -41,8 +63,27 @@ typedef enum barrier_types
     PTHREAD_type 
 }barrier_types_t;
 
+/*Adds try_lock_for() and try_lock_until() of std::TimedLockable to a lock which
+  provides timed_lock(nanoseconds)*/
+template <class L>
+class TimedLockable
+{
+    public:
+        template <class Rep, class Period>
+        bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time)
+        {
+            return static_cast<L*>(this)->timed_lock(std::chrono::ceil<std::chrono::nanoseconds>(rel_time));
+        }
+
+        template <class Clock, class Duration>
+        bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time)
+        {
+            return try_lock_for(abs_time - Clock::now());
+        }
+};
+
 /*TAS lock class definition*/
-class TAS 
+class TAS : public TimedLockable<TAS>
 {
     public:
         std::atomic<bool> taslock;
@@ -50,10 +91,20 @@ class TAS
         void TAS_lock();    //defined in locks.cpp
 
         void TAS_unlock();  //defined in locks.cpp
+
+        bool TAS_trylock(); //defined in locks.cpp
+
+        bool TAS_timedlock(std::chrono::nanoseconds timeout);   //defined in locks.cpp
+
+        /*std::Lockable & std::TimedLockable interface*/
+        void lock()                                     { TAS_lock(); }
+        void unlock()                                   { TAS_unlock(); }
+        bool try_lock()                                 { return TAS_trylock(); }
+        bool timed_lock(std::chrono::nanoseconds t)     { return TAS_timedlock(t); }
 };
 
 /*TTAS lock class definition*/
-class TTAS
+class TTAS : public TimedLockable<TTAS>
 {
     public:
         std::atomic<bool> ttaslock;
@@ -61,10 +112,20 @@ class TTAS
         void TTAS_lock();   //defined in locks.cpp
 
         void TTAS_unlock(); //defined in locks.cpp
+
+        bool TTAS_trylock();    //defined in locks.cpp
+
+        bool TTAS_timedlock(std::chrono::nanoseconds timeout);  //defined in locks.cpp
+
+        /*std::Lockable & std::TimedLockable interface*/
+        void lock()                                     { TTAS_lock(); }
+        void unlock()                                   { TTAS_unlock(); }
+        bool try_lock()                                 { return TTAS_trylock(); }
+        bool timed_lock(std::chrono::nanoseconds t)     { return TTAS_timedlock(t); }
 };
 
 /*Ticket Lock class definition*/
-class TicketLock
+class TicketLock : public TimedLockable<TicketLock>
 {
     public:
         std::atomic<int> next_num;
@@ -73,6 +134,16 @@ class TicketLock
         void Ticket_lock(); //defined in locks.cpp
 
         void Ticket_unlock();   //defined in locks.cpp
+
+        bool Ticket_trylock();  //defined in locks.cpp
+
+        bool Ticket_timedlock(std::chrono::nanoseconds timeout);    //defined in locks.cpp
+
+        /*std::Lockable & std::TimedLockable interface*/
+        void lock()                                     { Ticket_lock(); }
+        void unlock()                                   { Ticket_unlock(); }
+        bool try_lock()                                 { return Ticket_trylock(); }
+        bool timed_lock(std::chrono::nanoseconds t)     { return Ticket_timedlock(t); }
 };  
 
 /*Node class for MCS lock definition*/
@@ -84,15 +155,56 @@ class Node
 };
 
 /*MCS lock class definition*/
-class MCS
+class MCS : public TimedLockable<MCS>
 {
     public: 
         std::atomic<Node*> tail;
+        Node *owner;        /*node of the holder, only used by lock() & unlock()*/
 
         void acquire(Node *nodeptr);    //defined in locks.cpp
 
         void release(Node *nodeptr);    //defined in locks.cpp
 
+        bool try_acquire(Node *nodeptr);    //defined in locks.cpp
+
+        bool timed_acquire(Node *nodeptr, std::chrono::nanoseconds timeout);   //defined in locks.cpp
+
+        /*std::Lockable & std::TimedLockable interface, uses a node of the calling thread*/
+        void lock();                                    //defined in locks.cpp
+        void unlock();                                  //defined in locks.cpp
+        bool try_lock();                                //defined in locks.cpp
+        bool timed_lock(std::chrono::nanoseconds t);    //defined in locks.cpp
+};
+
+/*Node class for timeout CLH lock definition*/
+class CLHNode
+{
+    public:
+        std::atomic<CLHNode*> pred;     /*NULL while owner waits or holds the lock*/
+};
+
+/*Abortable CLH queue lock class definition, a waiter which times out leaves its
+  node in the queue and its successor skips over it*/
+class TimeoutCLH : public TimedLockable<TimeoutCLH>
+{
+    public:
+        std::atomic<CLHNode*> tail;
+        CLHNode *owner;             /*node of the holder, only used by lock() & unlock()*/
+        static CLHNode available;   /*pred of a released node*/
+
+        CLHNode* acquire();     //defined in locks.cpp
+
+        void release(CLHNode *nodeptr);     //defined in locks.cpp
+
+        CLHNode* try_acquire_for(std::chrono::nanoseconds timeout);    //defined in locks.cpp
+
+        void cleanup();         //defined in locks.cpp
+
+        /*std::Lockable & std::TimedLockable interface*/
+        void lock()                                     { owner = acquire(); }
+        void unlock()                                   { release(owner); }
+        bool try_lock()                                 { return timed_lock(std::chrono::nanoseconds(0)); }
+        bool timed_lock(std::chrono::nanoseconds t);    //defined in locks.cpp
 };
 
 /*Sense reversal barrier class definition*/
@@ -117,6 +229,207 @@ class Peterson
         void sequential_unlock(int threadId);   //defined in locks.cpp
         void released_lock(int threadId);   //defined in locks.cpp
         void released_unlock(int threadId); //defined in locks.cpp  
+        bool sequential_trylock(int threadId);  //defined in locks.cpp
+        bool released_trylock(int threadId);    //defined in locks.cpp
 };  
 
+/*ENUMERATED LIST OF ALL AVAILABLE READER-WRITER LOCKS*/
+typedef enum rwlock_types
+{
+    CENTRAL_RW_type = 0,
+    PHASEFAIR_RW_type,
+    DIST_RW_type
+}rwlock_types_t;
+
+/*Centralized reader-writer lock class definition, readers and writer share one counter*/
+class CentralRWLock
+{
+    public:
+        std::atomic<int> rwcount;   /*number of readers, -1 while a writer holds the lock*/
+
+        void read_lock();       //defined in locks.cpp
+        void read_unlock();     //defined in locks.cpp
+        void write_lock();      //defined in locks.cpp
+        void write_unlock();    //defined in locks.cpp
+};
+
+/*Phase-fair ticket reader-writer lock class definition, readers and writers alternate phases*/
+class PhaseFairRWLock
+{
+    public:
+        std::atomic<unsigned int> rin;      /*reader entries, low bits hold writer presence & phase*/
+        std::atomic<unsigned int> rout;     /*reader exits*/
+        std::atomic<unsigned int> win;      /*writer tickets*/
+        std::atomic<unsigned int> wout;     /*writer now serving*/
+
+        void read_lock();       //defined in locks.cpp
+        void read_unlock();     //defined in locks.cpp
+        void write_lock();      //defined in locks.cpp
+        void write_unlock();    //defined in locks.cpp
+};
+
+/*Reader indicator slot, one per thread, padded so readers never share a cache line*/
+class alignas(CACHE_LINE_SIZE) ReaderSlot
+{
+    public:
+        std::atomic<bool> active;
+};
+
+/*Distributed reader-writer lock class definition, readers only touch their own slot*/
+class DistRWLock
+{
+    public:
+        TTAS writerlock;            /*serializes writers*/
+        std::atomic<bool> writer;   /*set while a writer holds or waits for the lock*/
+        ReaderSlot *slots;          /*one per thread*/
+        int numSlots;
+
+        void read_lock(int slot);   //defined in locks.cpp
+        void read_unlock(int slot); //defined in locks.cpp
+        void write_lock();          //defined in locks.cpp
+        void write_unlock();        //defined in locks.cpp
+};
+
+/*Sequence lock class definition, readers never write shared memory and retry if a
+  writer was active while they read. Data guarded by it must be accessed through
+  relaxed atomics*/
+class SeqLock
+{
+    public:
+        std::atomic<unsigned int> seq;  /*odd while a writer is updating*/
+
+        void write_lock();                      //defined in locks.cpp
+        void write_unlock();                    //defined in locks.cpp
+        unsigned int read_begin();              //defined in locks.cpp
+        bool read_retry(unsigned int start);    //defined in locks.cpp
+};
+
+/*Backoff lock class definition, TTAS lock with exponential backoff*/
+class BackoffLock
+{
+    public:
+        std::atomic<bool> bolock;
+
+        void BO_lock();     //defined in locks.cpp
+
+        void BO_unlock();   //defined in locks.cpp
+
+        bool BO_trylock();  //defined in locks.cpp
+};
+
+/*Per-node state of C-BO-MCS cohort lock, padded to avoid false sharing between nodes*/
+class alignas(CACHE_LINE_SIZE) MCSCohort
+{
+    public:
+        MCS local;              /*lock shared by threads of this node*/
+        bool ownsGlobal;        /*global lock is held by this node, accessed under local lock*/
+        int passCount;          /*consecutive local handoffs, accessed under local lock*/
+};
+
+/*C-BO-MCS cohort lock class definition, global backoff lock with per-node MCS locks*/
+class CohortBOMCS
+{
+    public:
+        BackoffLock global;
+        MCSCohort *cohorts;     /*one per node*/
+        int numNodes;
+        int passBound;          /*max local handoffs before global lock is released*/
+
+        void acquire(int node, Node *nodeptr);  //defined in locks.cpp
+
+        void release(int node, Node *nodeptr);  //defined in locks.cpp
+
+        bool try_acquire(int node, Node *nodeptr);  //defined in locks.cpp
+};
+
+/*Per-node state of C-TKT-TKT cohort lock, padded to avoid false sharing between nodes*/
+class alignas(CACHE_LINE_SIZE) TicketCohort
+{
+    public:
+        TicketLock local;       /*lock shared by threads of this node*/
+        bool ownsGlobal;        /*global lock is held by this node, accessed under local lock*/
+        int passCount;          /*consecutive local handoffs, accessed under local lock*/
+};
+
+/*C-TKT-TKT cohort lock class definition, global ticket lock with per-node ticket locks*/
+class CohortTktTkt
+{
+    public:
+        TicketLock global;
+        TicketCohort *cohorts;  /*one per node*/
+        int numNodes;
+        int passBound;          /*max local handoffs before global lock is released*/
+
+        void acquire(int node); //defined in locks.cpp
+
+        void release(int node); //defined in locks.cpp
+
+        bool try_acquire(int node); //defined in locks.cpp
+};
+
+extern int cohortPassBound;     /*set by --cohort-bound, COHORT_DEFAULT_PASS_BOUND by default*/
+
+/*Condition variable class definition, works with any lock providing lock() & unlock().
+  Waiters spin for a while, then sleep on a futex*/
+class CondVar
+{
+    public:
+        std::atomic<unsigned int> seq;  /*incremented by every notification*/
+        std::atomic<int> waiters;       /*threads sleeping on seq*/
+
+        void wait_seq(unsigned int start);  //defined in locks.cpp
+
+        bool wait_seq_for(unsigned int start, std::chrono::nanoseconds timeout);   //defined in locks.cpp
+
+        void notify_one();  //defined in locks.cpp
+
+        void notify_all();  //defined in locks.cpp
+
+        /*releases the held lock, waits for a notification and reacquires the lock.
+          Wakeups may be spurious*/
+        template <class L>
+        void wait(L& lock)
+        {
+            unsigned int start = seq.load(SEQ_CST);
+            lock.unlock();
+            wait_seq(start);
+            lock.lock();
+        }
+
+        /*waits until pred() holds, pred() is checked with the lock held*/
+        template <class L, class Pred>
+        void wait(L& lock, Pred pred)
+        {
+            while (!pred())
+            {
+                wait(lock);
+            }
+        }
+
+        /*same as wait(), returns false if no notification arrived before timeout*/
+        template <class L>
+        bool wait_for(L& lock, std::chrono::nanoseconds timeout)
+        {
+            unsigned int start = seq.load(SEQ_CST);
+            lock.unlock();
+            bool notified = wait_seq_for(start, timeout);
+            lock.lock();
+            return notified;
+        }
+};
+
+/*Counting semaphore class definition, waiters spin for a while, then sleep on a futex*/
+class Semaphore
+{
+    public:
+        std::atomic<int> count;     /*available permits*/
+        std::atomic<int> waiters;   /*threads sleeping on count*/
+
+        void wait();        //defined in locks.cpp
+
+        bool try_wait();    //defined in locks.cpp
+
+        void post();        //defined in locks.cpp
+};
+
 #endif /*_LOCKS_H_*/
\ No newline at end of file
@@ -0,0 +1,489 @@
+/*
+ *  @fileName       :   locktrace.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include <algorithm>
+#include <vector>
+#include <tuple>
+#include <cstdio>
+
+#include "locktrace.h"
+#include "time.h"
+
+using namespace std;
+
+/*Private defines and macros*/
+#define TOP_HANDOFFS    (8)     /*busiest thread pairs printed per lock*/
+
+/*Private typedefs, classes, structs and unions*/
+/*one acquisition of a lock by one thread, times in ns since locktrace_reset()*/
+typedef struct lockEvent
+{
+    int lock;           /*id of the lock*/
+    bool contended;     /*lock was held by another thread while we asked for it*/
+    size_t from;        /*thread which released the lock before us, 0 if none*/
+    uint64_t request;   /*we started to acquire the lock*/
+    uint64_t acquired;  /*we got the lock*/
+    uint64_t released;  /*we let go of the lock*/
+    uint64_t handoff;   /*the previous owner let go of the lock*/
+}lockEvent_t;
+
+/*totals of one thread for one lock*/
+typedef struct lockStats
+{
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t failedTries;       /*trylock calls which found the lock held*/
+    uint64_t holdNs;
+    uint64_t waitNs;
+    uint64_t maxWaitNs;
+    vector<uint64_t> from;      /*contended acquisitions per releasing thread, indexed by threadId*/
+}lockStats_t;
+
+/*everything one thread records, only written by that thread while it runs*/
+typedef struct alignas(CACHE_LINE_SIZE) lockThread
+{
+    vector<lockEvent_t> ring;   /*last LOCKTRACE_RING acquisitions*/
+    uint64_t recorded;          /*acquisitions recorded, the next one goes to ring[recorded % LOCKTRACE_RING]*/
+    vector<lockStats_t> stats;  /*indexed by lock id*/
+    lockEvent_t cur;            /*acquisition in progress*/
+}lockThread_t;
+
+/*Global variables*/
+bool lockTraceFlag = false;             /*trace locks only when user asks for it*/
+static vector<lockThread_t> threads;    /*indexed by threadId-1*/
+static size_t numActive = 0;            /*threads taking part in the traced run*/
+static vector<string> lockNames;        /*indexed by lock id*/
+static struct timespec traceStart;      /*time 0 of the trace*/
+static bool traceStarted = false;       /*locktrace_reset() was called*/
+
+/*lock names as given to --lock, ordered as lock_algs_t*/
+static const char *algNames[] =
+{
+    "tas", "ttas", "ticket", "mcs", "pthread", "petersonseq", "petersonrel", "cbomcs", "ctkttkt", "clh"
+};
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   returns the time since locktrace_reset()
+ *
+ * @params      :   None
+ *
+ * @returns     :   uint64_t
+ *                      time in ns
+ */
+static inline uint64_t locktrace_now()
+{
+    struct timespec now;
+    getTime(&now);
+    return elapsed_ns(&traceStart, &now);
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   forgets every lock and acquisition traced so far and starts
+ *                  the clock of the trace. Called by the application once, and
+ *                  again wherever a new trace should begin, e.g. after the
+ *                  warmup runs
+ *
+ * @params      :   None
+ *
+ * @returns     :   None
+ */
+void locktrace_reset()
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    for (lockThread_t& t : threads)
+    {
+        t.recorded = 0;
+        t.stats.clear();
+    }
+    numActive = 0;
+    lockNames.clear();
+    getTime(&traceStart);
+    traceStarted = true;
+}
+
+/*
+ * @brief       :   makes room for numThreads threads, the acquisitions traced
+ *                  by earlier runs are kept. Called by the main thread before
+ *                  the workers run
+ *
+ * @params      :   size_t
+ *                      numThreads  :   number of threads taking part
+ *
+ * @returns     :   None
+ */
+void locktrace_init(size_t numThreads)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    if (!traceStarted)
+    {
+        locktrace_reset();
+    }
+    if (threads.size() < numThreads)
+    {
+        threads.resize(numThreads);
+    }
+    numActive = max(numActive, numThreads);
+
+    //the rings are allocated once, so that tracing does not allocate while sorting.
+    //Threads new to the trace get totals for the locks registered so far
+    lockStats_t empty = {};
+    empty.from.assign(numActive + 1, 0);
+    for (lockThread_t& t : threads)
+    {
+        t.ring.resize(LOCKTRACE_RING);
+        t.stats.resize(lockNames.size(), empty);
+        for (lockStats_t& s : t.stats)
+        {
+            s.from.resize(numActive + 1, 0);
+        }
+    }
+}
+
+/*
+ * @brief       :   gives a lock instance the id of its name and clears its
+ *                  tracing state. The same lock of a later run keeps adding to
+ *                  the same totals. Called by the main thread after
+ *                  locktrace_init()
+ *
+ * @params      :   lockTrace_t
+ *                      *lt     :   tracing state of the lock
+ *                  lock_algs_t
+ *                      alg     :   algorithm of the lock, for its name
+ *                  int
+ *                      index   :   index of the lock among the locks of a run
+ *
+ * @returns     :   None
+ */
+void locktrace_register(lockTrace_t *lt, lock_algs_t alg, int index)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    lt->owner.store(0, RELAXED);
+    lt->lastOwner = 0;
+    lt->lastRelease = 0;
+
+    const char *alias = (alg >= TAS_algorithm && alg <= TIMEOUT_CLH_algorithm) ? algNames[alg] : "lock";
+    string name = string(alias) + "#" + to_string(index);
+    lt->id = (int)(find(lockNames.begin(), lockNames.end(), name) - lockNames.begin());
+    if (lt->id < (int)lockNames.size())
+    {
+        return;
+    }
+    lockNames.push_back(name);
+
+    lockStats_t empty = {};
+    empty.from.assign(numActive + 1, 0);
+    for (lockThread_t& t : threads)
+    {
+        t.stats.resize(lockNames.size(), empty);
+    }
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   called before the lock is acquired, notes whether another
+ *                  thread holds it
+ *
+ * @params      :   lockTrace_t
+ *                      *lt         :   tracing state of the lock
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void locktrace_begin(lockTrace_t *lt, size_t threadId)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    lockEvent_t& cur = threads[threadId-1].cur;
+    cur.lock = lt->id;
+    cur.contended = (lt->owner.load(RELAXED) != 0);
+    cur.request = locktrace_now();
+}
+
+/*
+ * @brief       :   called once the lock is held, records who had it before.
+ *                  A release after our request also means we waited, this
+ *                  catches queue locks which are free for a moment between
+ *                  two owners
+ *
+ * @params      :   lockTrace_t
+ *                      *lt         :   tracing state of the lock
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void locktrace_acquired(lockTrace_t *lt, size_t threadId)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    lockEvent_t& cur = threads[threadId-1].cur;
+    cur.acquired = locktrace_now();
+    cur.from = lt->lastOwner;
+    cur.handoff = lt->lastRelease;
+    if (lt->lastOwner != 0 && lt->lastOwner != threadId && lt->lastRelease >= cur.request)
+    {
+        cur.contended = true;
+    }
+    lt->owner.store(threadId, RELAXED);
+}
+
+/*
+ * @brief       :   called when a trylock finds the lock held
+ *
+ * @params      :   lockTrace_t
+ *                      *lt         :   tracing state of the lock
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void locktrace_failed(lockTrace_t *lt, size_t threadId)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    threads[threadId-1].stats[lt->id].failedTries++;
+}
+
+/*
+ * @brief       :   called right before the lock is released, the totals are
+ *                  updated here as well. This is still inside the critical
+ *                  section, but only touches memory of the calling thread
+ *
+ * @params      :   lockTrace_t
+ *                      *lt         :   tracing state of the lock
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 1
+ *
+ * @returns     :   None
+ */
+void locktrace_release(lockTrace_t *lt, size_t threadId)
+{
+    if (!lockTraceFlag)
+    {
+        return;
+    }
+    lockThread_t& me = threads[threadId-1];
+    lockEvent_t& cur = me.cur;
+    cur.released = locktrace_now();
+    lt->lastOwner = threadId;
+    lt->lastRelease = cur.released;
+    lt->owner.store(0, RELAXED);
+
+    lockStats_t& s = me.stats[cur.lock];
+    uint64_t wait = cur.acquired - cur.request;
+    s.acquisitions++;
+    s.holdNs += cur.released - cur.acquired;
+    s.waitNs += wait;
+    s.maxWaitNs = max(s.maxWaitNs, wait);
+    if (cur.contended)
+    {
+        s.contended++;
+        if (cur.from != 0 && cur.from < s.from.size())
+        {
+            s.from[cur.from]++;
+        }
+    }
+
+    me.ring[me.recorded % LOCKTRACE_RING] = cur;
+    me.recorded++;
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   prints one row of the summary table
+ *
+ * @params      :   string
+ *                      name    :   lock or thread the row belongs to
+ *                  lockStats_t&
+ *                      s       :   totals of the row
+ *
+ * @returns     :   None
+ */
+static void print_row(string name, const lockStats_t& s)
+{
+    double n = (s.acquisitions > 0) ? (double)s.acquisitions : 1.0;
+    printf("%-16s%12lu%12lu%8.1lf%%%12lu%12.1lf%12.1lf%12.3lf%12.3lf%14.1lf\n",
+           name.c_str(), s.acquisitions, s.contended, 100.0 * s.contended / n, s.failedTries,
+           s.holdNs / n, s.waitNs / n, s.holdNs / 1000000.0, s.waitNs / 1000000.0, s.maxWaitNs / 1000.0);
+}
+
+/*
+ * @brief       :   writes the kept acquisitions as a Chrome trace, which can be
+ *                  opened in chrome://tracing or ui.perfetto.dev. Every thread
+ *                  is a track with a slice per wait and per hold, contended
+ *                  acquisitions get an arrow from the releasing thread
+ *
+ * @params      :   string
+ *                      traceFile   :   path of the JSON file
+ *
+ * @returns     :   bool
+ *                      false if the file cannot be written
+ */
+static bool write_chrome_trace(string traceFile)
+{
+    FILE *fp = fopen(traceFile.c_str(), "w");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"locks\"}}");
+    for (size_t t = 1; t <= numActive; t++)
+    {
+        fprintf(fp, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}", t, t);
+    }
+
+    unsigned long flowId = 0;
+    for (size_t t = 1; t <= numActive; t++)
+    {
+        lockThread_t& me = threads[t-1];
+        uint64_t first = (me.recorded > LOCKTRACE_RING) ? me.recorded - LOCKTRACE_RING : 0;
+        for (uint64_t i = first; i < me.recorded; i++)
+        {
+            lockEvent_t& ev = me.ring[i % LOCKTRACE_RING];
+            const char *name = lockNames[ev.lock].c_str();
+
+            //timestamps are in us
+            if (ev.acquired > ev.request)
+            {
+                fprintf(fp, ",\n{\"ph\":\"X\",\"cat\":\"wait\",\"name\":\"wait %s\",\"pid\":1,\"tid\":%zu,\"ts\":%.3lf,\"dur\":%.3lf}",
+                        name, t, ev.request / 1000.0, (ev.acquired - ev.request) / 1000.0);
+            }
+            fprintf(fp, ",\n{\"ph\":\"X\",\"cat\":\"hold\",\"name\":\"%s\",\"pid\":1,\"tid\":%zu,\"ts\":%.3lf,\"dur\":%.3lf,\"args\":{\"from\":%zu,\"contended\":%s}}",
+                    name, t, ev.acquired / 1000.0, (ev.released - ev.acquired) / 1000.0, ev.from, ev.contended ? "true" : "false");
+
+            //arrow from the end of the previous hold to the start of ours
+            if (ev.contended && ev.from != 0 && ev.from != t)
+            {
+                flowId++;
+                fprintf(fp, ",\n{\"ph\":\"s\",\"cat\":\"handoff\",\"name\":\"handoff\",\"id\":%lu,\"pid\":1,\"tid\":%zu,\"ts\":%.3lf}",
+                        flowId, ev.from, (ev.handoff > 0 ? ev.handoff - 1 : 0) / 1000.0);
+                fprintf(fp, ",\n{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"handoff\",\"name\":\"handoff\",\"id\":%lu,\"pid\":1,\"tid\":%zu,\"ts\":%.3lf}",
+                        flowId, t, ev.acquired / 1000.0);
+            }
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    return (fclose(fp) == 0);
+}
+
+/*
+ * @brief       :   prints acquisitions, contended acquisitions, failed
+ *                  trylocks, hold and wait times of every lock and thread,
+ *                  followed by the thread pairs which handed the lock over
+ *                  most often. Writes the timeline if a file is given
+ *
+ * @params      :   string
+ *                      traceFile   :   path of the Chrome trace, empty for none
+ *
+ * @returns     :   None
+ */
+void printLockTrace(string traceFile)
+{
+    if (!lockTraceFlag || lockNames.empty())
+    {
+        return;
+    }
+
+    printf("Lock trace, times in ns unless noted\n");
+    printf("%-16s%12s%12s%9s%12s%12s%12s%12s%12s%14s\n", "lock/thread", "acquired", "contended", "",
+           "failed-try", "avg-hold", "avg-wait", "hold(ms)", "wait(ms)", "max-wait(us)");
+
+    for (size_t l = 0; l < lockNames.size(); l++)
+    {
+        lockStats_t total = {};
+        total.from.assign(numActive + 1, 0);
+        vector<uint64_t> pairs((numActive + 1) * (numActive + 1), 0);
+
+        printf("%s\n", lockNames[l].c_str());
+        for (size_t t = 1; t <= numActive; t++)
+        {
+            const lockStats_t& s = threads[t-1].stats[l];
+            print_row("  " + to_string(t), s);
+
+            total.acquisitions += s.acquisitions;
+            total.contended += s.contended;
+            total.failedTries += s.failedTries;
+            total.holdNs += s.holdNs;
+            total.waitNs += s.waitNs;
+            total.maxWaitNs = max(total.maxWaitNs, s.maxWaitNs);
+            for (size_t f = 1; f <= numActive; f++)
+            {
+                pairs[f * (numActive + 1) + t] = s.from[f];
+            }
+        }
+        print_row("  total", total);
+
+        //busiest (releasing thread, acquiring thread) pairs
+        vector<tuple<uint64_t, size_t, size_t>> top;
+        for (size_t f = 1; f <= numActive; f++)
+        {
+            for (size_t t = 1; t <= numActive; t++)
+            {
+                if (pairs[f * (numActive + 1) + t] > 0)
+                {
+                    top.push_back({pairs[f * (numActive + 1) + t], f, t});
+                }
+            }
+        }
+        sort(top.rbegin(), top.rend());
+        printf("  handoffs:");
+        if (top.empty())
+        {
+            printf(" none");
+        }
+        for (size_t i = 0; i < top.size() && i < TOP_HANDOFFS; i++)
+        {
+            printf(" %zu->%zu (%lu)", get<1>(top[i]), get<2>(top[i]), get<0>(top[i]));
+        }
+        printf("\n");
+    }
+
+    for (size_t t = 1; t <= numActive; t++)
+    {
+        if (threads[t-1].recorded > LOCKTRACE_RING)
+        {
+            printf("Thread %zu: timeline keeps the last %d of %lu acquisitions\n", t, LOCKTRACE_RING, threads[t-1].recorded);
+        }
+    }
+
+    if (!traceFile.empty())
+    {
+        if (write_chrome_trace(traceFile))
+        {
+            printf("Lock timeline written to %s\n", traceFile.c_str());
+        }
+        else
+        {
+            printf("Failed to write lock timeline to %s\n", traceFile.c_str());
+        }
+    }
+}
+
+/*EOF*/
@@ -0,0 +1,52 @@
+/*
+ *  @fileName       :   locktrace.h
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+#ifndef _LOCK_TRACE_H_
+#define _LOCK_TRACE_H_
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstdbool>
+
+#include "locks.h"
+
+/*GLOBAL DEFINES*/
+#define LOCKTRACE_RING  (1 << 16)   /*acquisitions kept per thread for the timeline*/
+
+/*tracing state of one lock instance. owner is read by threads waiting for the
+  lock, the other fields are only touched while the lock is held*/
+typedef struct alignas(CACHE_LINE_SIZE) lockTrace
+{
+    int id;                         /*index of the lock in the summary*/
+    std::atomic<size_t> owner;      /*thread holding the lock, 0 if free*/
+    size_t lastOwner;               /*thread which released the lock last, 0 if none*/
+    uint64_t lastRelease;           /*time of that release, in ns*/
+}lockTrace_t;
+
+extern bool lockTraceFlag;  /*set by --lock-trace, every locktrace_* call is a no-op otherwise*/
+
+void locktrace_reset();
+
+void locktrace_init(size_t numThreads);
+
+void locktrace_register(lockTrace_t *lt, lock_algs_t alg, int index);
+
+void locktrace_begin(lockTrace_t *lt, size_t threadId);
+
+void locktrace_acquired(lockTrace_t *lt, size_t threadId);
+
+void locktrace_failed(lockTrace_t *lt, size_t threadId);
+
+void locktrace_release(lockTrace_t *lt, size_t threadId);
+
+void printLockTrace(std::string traceFile);
+
+#endif /*_LOCK_TRACE_H_*/
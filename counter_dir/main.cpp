@@ -20,6 +20,9 @@
 #include "counter.h"
 #include "locks.h"
 #include "time.h"
+#include "perf.h"
+#include "affinity.h"
+#include "locktrace.h"
 
 /*PRIVATE DEFINES*/
 #define DEFAULT_NUMTHREADS      (4)
@@ -33,7 +36,27 @@ enum
 {
     usr_name = 0,
     barriers, 
-    locks
+    locks,
+    perf,
+    pin,
+    cpus,
+    nodes,
+    cohort_bound,
+    rwlocks,
+    read_pct,
+    statistic,
+    writers,
+    pipeline,
+    producers,
+    repeat,
+    warmup,
+    lock_trace,
+    num_locks,
+    zipf,
+    cs_lines,
+    think,
+    think_ns,
+    burst
 };
 
 /*--------------------------------------------------------------------*/
@@ -44,12 +67,36 @@ struct option long_cmd_options[] =
 {
     {"name", no_argument, 0, usr_name},
     {"bar", required_argument, 0, barriers},
-    {"lock", required_argument, 0, locks}
+    {"lock", required_argument, 0, locks},
+    {"perf", no_argument, 0, perf},
+    {"pin", required_argument, 0, pin},
+    {"cpus", required_argument, 0, cpus},
+    {"nodes", required_argument, 0, nodes},
+    {"cohort-bound", required_argument, 0, cohort_bound},
+    {"rw", required_argument, 0, rwlocks},
+    {"read-pct", required_argument, 0, read_pct},
+    {"stats", required_argument, 0, statistic},
+    {"writers", required_argument, 0, writers},
+    {"pipe", required_argument, 0, pipeline},
+    {"producers", required_argument, 0, producers},
+    {"repeat", required_argument, 0, repeat},
+    {"warmup", required_argument, 0, warmup},
+    {"lock-trace", required_argument, 0, lock_trace},
+    {"num-locks", required_argument, 0, num_locks},
+    {"zipf", required_argument, 0, zipf},
+    {"cs-lines", required_argument, 0, cs_lines},
+    {"think", required_argument, 0, think},
+    {"think-ns", required_argument, 0, think_ns},
+    {"burst", required_argument, 0, burst},
+    {0, 0, 0, 0}
 };
 
 /*short commands*/
 const char *short_cmd_options = "i:t:o:";
 
+/*settings of the run, filled from the command line*/
+static counterConfig_t runConfig;
+
 /*--------------------------------------------------------------------*/
 /*
  * @brief       :   writes the sorted list to a file
@@ -123,6 +170,18 @@ static void determine_lock_and_barrier(string locktype, string barriertype, lock
     {
         *alg = PETERSON_REL_algorithm;
     }
+    else if (locktype == "cbomcs")
+    {
+        *alg = COHORT_BO_MCS_algorithm;
+    }
+    else if (locktype == "ctkttkt")
+    {
+        *alg = COHORT_TKT_TKT_algorithm;
+    }
+    else if (locktype == "clh")
+    {
+        *alg = TIMEOUT_CLH_algorithm;
+    }
     else    /*default algorithm is pthread*/
     {
         *alg = PTHREAD_algorithm;
@@ -140,6 +199,74 @@ static void determine_lock_and_barrier(string locktype, string barriertype, lock
     }
 }
 
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   determines which workload is to be run, and which
+ *                  reader-writer lock, statistic guard or blocking primitive
+ *                  it uses
+ * 
+ * @parameters  :   string
+ *                      rwType      :   reader-writer lock, empty if not used
+ *                      statsType   :   guard of the statistic, empty if not used
+ *                      pipeType    :   blocking primitive of the buffer, empty if not used
+ *                  bool
+ *                      barrierFlag :   whether user selected a barrier
+ *
+ * @returns     :   counter_modes_t
+ *                      workload to be run
+ */
+static counter_modes_t determine_mode(string rwType, string statsType, string pipeType, bool barrierFlag)
+{
+    if (!pipeType.empty())
+    {
+        //barrier is only used to synchronize timing in this mode
+        if (pipeType == "sem")
+        {
+            runConfig.pipe = SEMAPHORE_pipe;
+        }
+        else    /*default is condition variables*/
+        {
+            runConfig.pipe = CONDVAR_pipe;
+        }
+        return PIPE_mode;
+    }
+    if (!statsType.empty())
+    {
+        //barrier is only used to synchronize timing in this mode
+        if (statsType == "mutex")
+        {
+            runConfig.statsguard = MUTEX_guard;
+        }
+        else    /*default guard is the sequence lock*/
+        {
+            runConfig.statsguard = SEQLOCK_guard;
+        }
+        return STATS_mode;
+    }
+    if (!rwType.empty())
+    {
+        //barrier is only used to synchronize timing in this mode
+        if (rwType == "phasefair")
+        {
+            runConfig.rw = PHASEFAIR_RW_type;
+        }
+        else if (rwType == "dist")
+        {
+            runConfig.rw = DIST_RW_type;
+        }
+        else    /*default reader-writer lock is centralized*/
+        {
+            runConfig.rw = CENTRAL_RW_type;
+        }
+        return RWLOCK_mode;
+    }
+    if (barrierFlag)
+    {
+        return BARRIER_mode;
+    }
+    return LOCK_mode;
+}
+
 /*--------------------------------------------------------------------*/
 /*
  * @brief       :   determines number of threads to be used
@@ -161,6 +288,44 @@ static int determine_numThreads(string lockType, int num_threads)
     return num_threads; 
 }
 
+/*--------------------------------------------------------------------*/
+/*
+ * @brief       :   determines how threads are to be pinned to cpus
+ * 
+ * @parameters  :   string
+ *                      pinType     :   compact, scatter or none
+ *                      cpuList     :   explicit list of cpus, e.g. 0,2,4-7
+ *
+ * @returns     :   none, exits with EXIT_FAILURE if the cpu list is malformed
+ */
+static void determine_pinning(string pinType, string cpuList)
+{
+    pin_policy_t policy = PIN_NONE;
+
+    if (!cpuList.empty())
+    {
+        policy = PIN_LIST;
+    }
+    else if (pinType == "compact")
+    {
+        policy = PIN_COMPACT;
+    }
+    else if (pinType == "scatter")
+    {
+        policy = PIN_SCATTER;
+    }
+    else    /*threads are not pinned by default*/
+    {
+        policy = PIN_NONE;
+    }
+
+    if (!pin_init(policy, cpuList))
+    {
+        cout << "Invalid cpu list, exiting ..." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
 /*--------------------------------------------------------------------*/
 /*
  * @brief       :   application entry point
@@ -184,6 +349,9 @@ int main(int argc, char* argv[])
 
     string lockType, barrierType; 
 
+    //thread placement
+    string pinType, cpuList;
+
     //number of threads
     int num_threads=0;
     int num_iterations=0;
@@ -191,6 +359,22 @@ int main(int argc, char* argv[])
     bool nameflag = false;
     bool barrierFlag = false;
 
+    //reader-writer lock, empty if not used
+    string rwType;
+
+    //guard of the statistic, empty if not used
+    string statsType;
+
+    //blocking primitive of the pipeline buffer, empty if not used
+    string pipeType;
+
+    //measured runs and unmeasured runs before them
+    int numRuns = 1;
+    int numWarmup = 0;
+
+    //Chrome trace written by --lock-trace
+    string lockTraceFile;
+
     //get command line arguments that start with '-' or '--'
     while((opt = getopt_long(argc, argv, short_cmd_options, long_cmd_options, NULL)) != -1)
     {
@@ -223,6 +407,118 @@ int main(int argc, char* argv[])
                 barrierFlag = true;
             break;
 
+            case perf:
+                //collect hardware counters around the timed region
+                perfFlag = true;
+            break;
+
+            case pin:
+                //thread placement policy
+                pinType = optarg;
+            break;
+
+            case cpus:
+                //explicit list of cpus, overrides --pin
+                cpuList = optarg;
+            break;
+
+            case nodes:
+                //split threads into groups to simulate numa nodes for cohort locks
+                simulatedNodes = atoi(optarg);
+            break;
+
+            case cohort_bound:
+                //local handoffs of cohort locks before the global lock is released
+                cohortPassBound = atoi(optarg);
+            break;
+
+            case rwlocks:
+                //reader-writer lock, switches to the read/write workload
+                rwType = optarg;
+            break;
+
+            case read_pct:
+                //percentage of reads in the read/write workload
+                runConfig.readPercent = atoi(optarg);
+            break;
+
+            case statistic:
+                //guard of the statistic, switches to the snapshot workload
+                statsType = optarg;
+            break;
+
+            case writers:
+                //threads updating the statistic in the snapshot workload
+                runConfig.numWriters = atoi(optarg);
+            break;
+
+            case pipeline:
+                //blocking primitive, switches to the producer/consumer workload
+                pipeType = optarg;
+            break;
+
+            case producers:
+                //producer threads in the producer/consumer workload
+                runConfig.numProducers = atoi(optarg);
+            break;
+
+            case repeat:
+                //run the workload this many times and report statistics
+                numRuns = max(1, atoi(optarg));
+            break;
+
+            case warmup:
+                //runs before the measured ones, not reported
+                numWarmup = max(0, atoi(optarg));
+            break;
+
+            case lock_trace:
+                //trace every acquisition of the lock, timeline goes to a JSON file
+                lockTraceFlag = true;
+                lockTraceFile = optarg;
+            break;
+
+            case num_locks:
+                //locks of the counting workload, every iteration picks one
+                runConfig.numLocks = max(1, atoi(optarg));
+            break;
+
+            case zipf:
+                //skew of the lock choice, 0 picks every lock equally often
+                runConfig.zipf = max(0.0, atof(optarg));
+            break;
+
+            case cs_lines:
+                //cache lines written in every critical section
+                runConfig.csLines = max(0, atoi(optarg));
+            break;
+
+            case think:
+                //distribution of the think time between two acquisitions
+                if (string(optarg) == "exp")
+                {
+                    runConfig.think = EXP_think;
+                }
+                else if (string(optarg) == "uniform")
+                {
+                    runConfig.think = UNIFORM_think;
+                }
+                else    /*default is a constant think time*/
+                {
+                    runConfig.think = CONST_think;
+                }
+            break;
+
+            case think_ns:
+                //mean think time between two acquisitions
+                runConfig.thinkNs = max(0, atoi(optarg));
+            break;
+
+            case burst:
+                //acquisitions made back-to-back before thinking for all of them
+                runConfig.burst = max(1, atoi(optarg));
+            break;
+
             case 't':
                 //number of threads
                 num_threads = atoi(optarg);
@@ -245,13 +541,54 @@ int main(int argc, char* argv[])
 
     if (!nameflag)
     {
+        determine_pinning(pinType, cpuList);
+
         lock_algs_t alg; barrier_types_t bar; 
         determine_lock_and_barrier(lockType, barrierType, &alg, &bar);
         int numThreads = determine_numThreads(lockType, num_threads);
-        int count = counter(alg, bar, barrierFlag, num_iterations, numThreads);
+        runConfig.mode = determine_mode(rwType, statsType, pipeType, barrierFlag);
+        runConfig.lock = alg;
+        runConfig.bar = bar;
+        runConfig.numIterations = num_iterations;
+        runConfig.numThreads = numThreads;
+
+        //every run starts from a zero counter and fresh locks
+        Counter *counter = counter_init(runConfig);
+        counterResult_t result;
+        vector<unsigned long long> runTimes;
+        locktrace_reset();
+        for (int r = 0; r < numWarmup + numRuns; r++)
+        {
+            if ((r == numWarmup) && (numWarmup > 0))
+            {
+                locktrace_reset();      //trace only the measured runs
+            }
+            result = counter->run();
+            if (r >= numWarmup)
+            {
+                runTimes.push_back(result.elapsedNs);
+            }
+        }
+        counter_delete(counter);    /*stop the workers of the counter*/
+
         //write sorted list to file 
-        writeToFile(op_filename, count);
-        printTimeDifference();
+        writeToFile(op_filename, result.count);
+        startTime = result.startTime;
+        endTime = result.endTime;
+        if (numRuns > 1)
+        {
+            printTimeStats(runTimes, numWarmup);
+        }
+        else
+        {
+            printTimeDifference();
+        }
+        if (runConfig.mode == STATS_mode)
+        {
+            printStatsSummary(result);
+        }
+        printPerfCounters();
+        printLockTrace(lockTraceFile);
     }
 
     return 0;
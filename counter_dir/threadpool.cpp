@@ -0,0 +1,124 @@
+/*
+ *  @fileName       :   threadpool.cpp
+ *
+ *  @author         :   tanmay-mk
+ *
+ *  @date           :   26 Oct 2022
+ *
+ */
+
+/*LIBRARY FILES*/
+#include "threadpool.h"
+
+using namespace std;
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   main loop of a pool worker, waits for a job, runs it if the
+ *                  worker takes part and reports completion
+ *
+ * @params      :   ThreadPool
+ *                      *tp         :   pool the worker belongs to
+ *                  size_t
+ *                      threadId    :   Unique id of thread, starting from 2
+ *
+ * @returns     :   None
+ */
+static void pool_worker(ThreadPool *tp, size_t threadId)
+{
+    while (true)
+    {
+        //park here until the caller publishes the next job
+        tp->start->arrive_and_wait();
+        if (tp->quit)
+        {
+            break;
+        }
+
+        if (threadId <= tp->jobThreads)
+        {
+            tp->job(threadId);
+        }
+
+        tp->done->arrive_and_wait();
+    }
+}
+
+/*
+ * @brief       :   runs a job on the first n threads of the pool, the calling
+ *                  thread runs it as thread 1 and returns when all are done
+ *
+ * @params      :   pool_job_t
+ *                      fn      :   job to be run
+ *                  size_t
+ *                      n       :   number of threads taking part
+ *
+ * @returns     :   None
+ */
+void ThreadPool::run(pool_job_t fn, size_t n)
+{
+    //barriers order these stores before the workers read them
+    job = fn;
+    jobThreads = n;
+
+    start->arrive_and_wait();
+    job(1);
+    done->arrive_and_wait();
+}
+
+/*---------------------------------------------------------------------------------*/
+/*
+ * @brief       :   creates a pool of numThreads - 1 parked workers, owned by
+ *                  the caller
+ *
+ * @params      :   size_t
+ *                      numThreads  :   threads of every job, including the caller
+ *
+ * @returns     :   ThreadPool*
+ *                      new pool, deleted with pool_destroy()
+ */
+ThreadPool* pool_create(size_t numThreads)
+{
+    ThreadPool *tp = new ThreadPool;
+    tp->numThreads = numThreads;
+    tp->start = new barrier(numThreads);
+    tp->done = new barrier(numThreads);
+    tp->jobThreads = 0;
+    tp->quit = false;
+
+    for (size_t i = 1; i < numThreads; i++)
+    {
+        tp->workers.push_back(new thread(pool_worker, tp, i+1));
+    }
+    return tp;
+}
+
+/*
+ * @brief       :   stops and joins all workers of a pool and deletes it
+ *
+ * @params      :   ThreadPool
+ *                      *tp     :   pool to be deleted, may be NULL
+ *
+ * @returns     :   None
+ */
+void pool_destroy(ThreadPool *tp)
+{
+    if (tp == NULL)
+    {
+        return;
+    }
+
+    tp->quit = true;
+    tp->start->arrive_and_wait();
+    for (thread *t : tp->workers)
+    {
+        t->join();
+        delete t;
+    }
+
+    delete tp->start;
+    delete tp->done;
+    delete tp;
+}
+
+/*EOF*/
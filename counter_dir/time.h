@@ -11,12 +11,17 @@
 #define _TIME_H_
 
 #include <iostream>
+#include <vector>
 #include <ctime>
 
 extern struct timespec startTime, endTime;
 
 void getTime(struct timespec *dest);
 
+unsigned long long elapsed_ns(const struct timespec *start, const struct timespec *end);
+
 void printTimeDifference();
 
+void printTimeStats(std::vector<unsigned long long> samples, int warmup);
+
 #endif /*_TIME_H_*/
\ No newline at end of file
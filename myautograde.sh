@@ -11,6 +11,7 @@ YELLOW='\033[1;33m'
 NOCOLOR='\033[0m'
 
 SCORE=0
+TOTAL=0     # points of every test run, the score of a clean pass
 
 ### Autograder for counter
 
@@ -29,7 +30,7 @@ fi
 
 for ((th=1; th<=4; th++)) do
     echo ----------------------------------------------------------
-    for prim in "--lock=tas" "--lock=ttas" "--lock=ticket" "--lock=pthread" "--lock=mcs" "--lock=petersonseq" "--lock=petersonrel" "--bar=sense" "--bar=pthread" ; do
+    for prim in "--lock=tas" "--lock=ttas" "--lock=ticket" "--lock=pthread" "--lock=mcs" "--lock=petersonseq" "--lock=petersonrel" "--lock=cbomcs" "--lock=ctkttkt" "--lock=clh" "--bar=sense" "--bar=pthread" ; do
         for file in $TESTDIR/*; do
             if [ "${file: -4}" == ".cnt" ]
             then
@@ -44,6 +45,7 @@ for ((th=1; th<=4; th++)) do
                     ANS=$((ITERS*th))
                 fi
                 $EXEC -o $MY -t $th -i $ITERS $prim
+                TOTAL=$(($TOTAL+2))
                 read -r MYANS < $MY
                 if [ $MYANS -eq $ANS ]
                 then 
@@ -74,7 +76,7 @@ chmod u+x $EXEC
 
 for ((th=1; th<=4; th++)) do
     for bar in "--bar=sense" "--bar=pthread" ; do
-        for lock in "--lock=tas" "--lock=ttas" "--lock=ticket" "--lock=pthread" "--lock=mcs" "--lock=petersonseq" "--lock=petersonrel" ; do
+        for lock in "--lock=tas" "--lock=ttas" "--lock=ticket" "--lock=pthread" "--lock=mcs" "--lock=petersonseq" "--lock=petersonrel" "--lock=cbomcs" "--lock=ctkttkt" "--lock=clh" ; do
             for file in $TESTDIR/*; do
                 if [ "${file: -4}" == ".txt" ]
                 then
@@ -82,7 +84,8 @@ for ((th=1; th<=4; th++)) do
                     CASE=${IN%.*}
                     MY=$CASE.my
                     ANS=$CASE.ans
-                    $EXEC $IN -o $MY -t $th $prim
+                    $EXEC $IN -o $MY -t $th $lock $bar
+                    TOTAL=$(($TOTAL+8))
                     if cmp --silent $MY $ANS;
                     then 
                         SCORE=$(($SCORE+8))
@@ -96,12 +99,36 @@ for ((th=1; th<=4; th++)) do
         done
     done
 done
+for ((th=1; th<=4; th++)) do
+    for mode in "--engine=radix" "--engine=mergesort" "--mem-limit=64K" "--mem-limit=64K --engine=radix" "--key-type=i32" "--key-type=u64" "--payload=16" "--payload=16 --stable" "--stable" ; do
+        for file in $TESTDIR/*; do
+            if [ "${file: -4}" == ".txt" ]
+            then
+                IN=$file
+                CASE=${IN%.*}
+                MY=$CASE.my
+                ANS=$CASE.ans
+                $EXEC $IN -o $MY -t $th $mode
+                TOTAL=$(($TOTAL+8))
+                if cmp --silent $MY $ANS;
+                then 
+                    SCORE=$(($SCORE+8))
+                    echo -e $CASE $mode -t $th "..... ${GREEN}Pass${NOCOLOR}"
+                else 
+                    echo -e $CASE $mode -t $th "..... ${RED}FAIL${NOCOLOR}"
+                fi
+            fi
+            rm -rf $MY
+        done
+    done
+done
 SCORE=$(echo "scale=1; $SCORE/2" | bc -l)
+TOTAL=$(echo "scale=1; $TOTAL/2" | bc -l)
 
-echo -e "${YELLOW}Score:" $SCORE "${NOCOLOR}"
+echo -e "${YELLOW}Score:" $SCORE / $TOTAL "${NOCOLOR}"
 
 RET=1
-if [ $SCORE == "25.0" ]
+if [ $SCORE == $TOTAL ]
 	then
 	RET=0
 fi